@@ -0,0 +1,209 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "analyzer_task.hpp"
+
+namespace zldsp::analyzer {
+    /**
+     * a process-wide scheduler which runs the analysis of all registered tasks
+     * once per display frame, it collects the visible tasks which are due and not still running,
+     * sorts them by priority and deadline, and spreads them over a bounded thread pool
+     * the threads start with the first registered task and stop with the last unregistered one
+     */
+    class AnalyzerService {
+    public:
+        using Clock = AnalyzerTask::Clock;
+
+        static constexpr size_t kMaxThreadNum = 4;
+
+        static AnalyzerService &getInstance() {
+            static AnalyzerService service;
+            return service;
+        }
+
+        AnalyzerService(const AnalyzerService &) = delete;
+
+        AnalyzerService &operator=(const AnalyzerService &) = delete;
+
+        ~AnalyzerService() {
+            std::lock_guard<std::mutex> thread_lock{thread_mutex_};
+            // stop even if tasks are still registered, a joinable thread must not be destroyed
+            stopThreads(true);
+        }
+
+        /**
+         * register a task, the task must be unregistered before it is destroyed
+         * @param task
+         */
+        void registerTask(AnalyzerTask &task) {
+            std::lock_guard<std::mutex> thread_lock{thread_mutex_}; {
+                std::lock_guard<std::mutex> lock{mutex_};
+                if (std::find(tasks_.begin(), tasks_.end(), &task) != tasks_.end()) return;
+                task.deadline_ = Clock::now();
+                task.is_queued_ = false;
+                tasks_.emplace_back(&task);
+            }
+            startThreads();
+        }
+
+        /**
+         * unregister a task, blocks until the task is no longer running
+         * @param task
+         */
+        void unregisterTask(AnalyzerTask &task) {
+            std::lock_guard<std::mutex> thread_lock{thread_mutex_};
+            bool to_stop{false}; {
+                std::unique_lock<std::mutex> lock{mutex_};
+                const auto it = std::find(tasks_.begin(), tasks_.end(), &task);
+                if (it == tasks_.end()) return;
+                tasks_.erase(it);
+                const auto qt = std::find(queue_.begin(), queue_.end(), &task);
+                if (qt != queue_.end()) {
+                    queue_.erase(qt);
+                    task.is_queued_ = false;
+                }
+                finished_cv_.wait(lock, [&]() { return !task.is_queued_; });
+                to_stop = tasks_.empty();
+            }
+            if (to_stop) stopThreads();
+        }
+
+        /**
+         * set the frame period, e.g. the display refresh period
+         * @param x
+         */
+        void setFramePeriod(const Clock::duration x) {
+            std::lock_guard<std::mutex> lock{mutex_};
+            frame_period_ = x;
+        }
+
+        /**
+         * set the number of pool threads, takes effect when the threads restart
+         * @param x clamped to [1, kMaxThreadNum]
+         */
+        void setThreadNum(const size_t x) {
+            std::lock_guard<std::mutex> lock{mutex_};
+            thread_num_ = std::clamp(x, static_cast<size_t>(1), kMaxThreadNum);
+        }
+
+    private:
+        // serializes starting and stopping the threads
+        std::mutex thread_mutex_;
+        std::mutex mutex_;
+        std::condition_variable frame_cv_, work_cv_, finished_cv_;
+        std::vector<AnalyzerTask *> tasks_;
+        std::deque<AnalyzerTask *> queue_;
+        std::vector<AnalyzerTask *> due_tasks_;
+        Clock::duration frame_period_{std::chrono::milliseconds(16)};
+        size_t thread_num_{getDefaultThreadNum()};
+        bool to_exit_{false};
+        std::thread frame_thread_;
+        std::vector<std::thread> pool_threads_;
+
+        AnalyzerService() = default;
+
+        static size_t getDefaultThreadNum() {
+            const auto num = static_cast<size_t>(std::thread::hardware_concurrency());
+            return std::clamp(num / 4, static_cast<size_t>(1), kMaxThreadNum);
+        }
+
+        void startThreads() {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (frame_thread_.joinable()) return;
+            to_exit_ = false;
+            frame_thread_ = std::thread([this]() { frameLoop(); });
+            for (size_t i = 0; i < thread_num_; ++i) {
+                pool_threads_.emplace_back([this]() { poolLoop(); });
+            }
+        }
+
+        /**
+         * @param force stop the threads even if tasks are still registered
+         */
+        void stopThreads(const bool force = false) {
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                if (!frame_thread_.joinable() || (!force && !tasks_.empty())) return;
+                to_exit_ = true;
+            }
+            frame_cv_.notify_all();
+            work_cv_.notify_all();
+            frame_thread_.join();
+            for (auto &t: pool_threads_) {
+                t.join();
+            }
+            pool_threads_.clear();
+        }
+
+        /**
+         * wake up once per frame and queue the due tasks
+         */
+        void frameLoop() {
+            std::unique_lock<std::mutex> lock{mutex_};
+            auto next_frame = Clock::now();
+            while (!to_exit_) {
+                const auto now = Clock::now();
+                due_tasks_.clear();
+                for (auto *task: tasks_) {
+                    // a task which is still queued or running from the last frame is not queued twice
+                    // half a frame of tolerance keeps tasks with interval == frame period on every frame
+                    if (task->is_queued_ || !task->getVisible() || task->deadline_ > now + frame_period_ / 2) continue;
+                    due_tasks_.emplace_back(task);
+                }
+                if (!due_tasks_.empty()) {
+                    for (auto *task: due_tasks_) {
+                        task->is_queued_ = true;
+                        queue_.emplace_back(task);
+                    }
+                    // tasks left from previous frames compete with the new ones
+                    std::sort(queue_.begin(), queue_.end(), [](const AnalyzerTask *a, const AnalyzerTask *b) {
+                        const auto pa = a->getPriority(), pb = b->getPriority();
+                        return pa != pb ? pa > pb : a->deadline_ < b->deadline_;
+                    });
+                    work_cv_.notify_all();
+                }
+                // skip the frames which have been missed instead of catching up
+                next_frame += frame_period_;
+                if (next_frame < now) {
+                    next_frame = now + frame_period_;
+                }
+                frame_cv_.wait_until(lock, next_frame, [this]() { return to_exit_; });
+            }
+        }
+
+        /**
+         * run the queued tasks
+         */
+        void poolLoop() {
+            std::unique_lock<std::mutex> lock{mutex_};
+            while (true) {
+                work_cv_.wait(lock, [this]() { return to_exit_ || !queue_.empty(); });
+                if (to_exit_) return;
+                auto *task = queue_.front();
+                queue_.pop_front();
+                lock.unlock(); {
+                    std::lock_guard<std::mutex> result_lock{task->getResultLock()};
+                    task->runAnalysis();
+                }
+                lock.lock();
+                task->deadline_ = std::max(task->deadline_ + task->getInterval(), Clock::now() - frame_period_);
+                task->is_queued_ = false;
+                finished_cv_.notify_all();
+            }
+        }
+    };
+}
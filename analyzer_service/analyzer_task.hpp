@@ -0,0 +1,104 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace zldsp::analyzer {
+    /**
+     * a unit of analysis work which is scheduled by the AnalyzerService
+     * runAnalysis is called from a service thread while the result lock is held,
+     * hold getResultLock() on the message thread while reading the results, e.g. creating paths
+     */
+    class AnalyzerTask {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        AnalyzerTask() = default;
+
+        virtual ~AnalyzerTask() = default;
+
+        /**
+         * run the analysis, e.g. MultipleFFTBase::run
+         */
+        virtual void runAnalysis() = 0;
+
+        /**
+         * hidden tasks are skipped, e.g. when the editor is closed or minimized
+         * @param x
+         */
+        void setVisible(const bool x) {
+            is_visible_.store(x, std::memory_order::relaxed);
+        }
+
+        [[nodiscard]] bool getVisible() const {
+            return is_visible_.load(std::memory_order::relaxed);
+        }
+
+        /**
+         * tasks with higher priorities are dispatched first within a frame
+         * @param x
+         */
+        void setPriority(const int x) {
+            priority_.store(x, std::memory_order::relaxed);
+        }
+
+        [[nodiscard]] int getPriority() const {
+            return priority_.load(std::memory_order::relaxed);
+        }
+
+        /**
+         * the task is due once the interval has passed since its last run
+         * among tasks with the same priority, the earliest deadline is dispatched first
+         * @param x
+         */
+        void setInterval(const Clock::duration x) {
+            interval_.store(x.count(), std::memory_order::relaxed);
+        }
+
+        [[nodiscard]] Clock::duration getInterval() const {
+            return Clock::duration(interval_.load(std::memory_order::relaxed));
+        }
+
+        std::mutex &getResultLock() { return result_lock_; }
+
+    private:
+        friend class AnalyzerService;
+
+        std::atomic<bool> is_visible_{true};
+        std::atomic<int> priority_{0};
+        std::atomic<Clock::rep> interval_{Clock::duration(std::chrono::milliseconds(16)).count()};
+        std::mutex result_lock_;
+
+        // the following fields are guarded by the service lock
+        Clock::time_point deadline_{};
+        bool is_queued_{false};
+    };
+
+    /**
+     * an AnalyzerTask which calls run() of an analyzer, e.g. MultipleFFTBase or MultipleMagAnalyzer
+     * @tparam Analyzer
+     */
+    template<typename Analyzer>
+    class AnalyzerRunTask final : public AnalyzerTask {
+    public:
+        explicit AnalyzerRunTask(Analyzer &analyzer) : analyzer_(analyzer) {
+        }
+
+        void runAnalysis() override {
+            analyzer_.run();
+        }
+
+    private:
+        Analyzer &analyzer_;
+    };
+}
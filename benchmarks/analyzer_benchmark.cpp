@@ -0,0 +1,70 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <benchmark/benchmark.h>
+
+#include "vector/vector.hpp"
+#include "fft_analyzer/fft_analyzer.hpp"
+#include "mag_analyzer/mag_analyzer.hpp"
+#include "benchmark_buffers.hpp"
+
+namespace {
+    constexpr size_t kPointNum = 251;
+
+    /**
+     * one run of two synchronized FFTs of order range(0), fed with one FFT size of stereo samples
+     * range(1) switches to the constant-Q transform
+     */
+    void BM_MultipleFFTRun(benchmark::State &state) {
+        const auto fft_order = static_cast<size_t>(state.range(0));
+        const auto num_samples = static_cast<size_t>(1) << fft_order;
+        zldsp::analyzer::MultipleFFTBase<float, 2, kPointNum> analyzer(fft_order);
+        analyzer.setConstantQ(state.range(1) != 0);
+        analyzer.prepare(48000.0);
+        analyzer.setON({true, true});
+        zldsp::bench::NoiseBuffers<float> pre(2, num_samples), post(2, num_samples);
+        for (auto _: state) {
+            analyzer.process({pre.getSpan(), post.getSpan()}, num_samples);
+            analyzer.run();
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_samples));
+    }
+
+    /**
+     * three magnitude meters on range(0) channels of range(1) samples per block, in mode range(2)
+     * the FIFO is drained in every iteration, so that process never takes the overflow path
+     */
+    void BM_MultipleMagProcess(benchmark::State &state) {
+        const auto num_channels = static_cast<size_t>(state.range(0));
+        const auto num_samples = static_cast<size_t>(state.range(1));
+        zldsp::analyzer::MultipleMagAnalyzer<float, 3, kPointNum> analyzer;
+        analyzer.setMagType(static_cast<zldsp::analyzer::MagType>(state.range(2)));
+        analyzer.prepare(48000.0);
+        zldsp::bench::NoiseBuffers<float> buffer0(num_channels, num_samples), buffer1(num_channels, num_samples),
+                buffer2(num_channels, num_samples);
+        for (auto _: state) {
+            analyzer.process({buffer0.getSpan(), buffer1.getSpan(), buffer2.getSpan()}, num_samples);
+            benchmark::DoNotOptimize(analyzer.run());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_channels * num_samples));
+    }
+}
+
+BENCHMARK(BM_MultipleFFTRun)
+    ->ArgNames({"order", "constant_q"})
+    ->ArgsProduct({{11, 12, 13}, {0, 1}});
+
+BENCHMARK(BM_MultipleMagProcess)
+    ->ArgNames({"channels", "block", "type"})
+    ->ArgsProduct({
+        zldsp::bench::kChannelNums, zldsp::bench::kBlockSizes,
+        {zldsp::analyzer::MagType::kPeak, zldsp::analyzer::MagType::kRMS, zldsp::analyzer::MagType::kStats}
+    });
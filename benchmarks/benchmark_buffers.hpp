@@ -0,0 +1,50 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace zldsp::bench {
+    // the block sizes and channel counts of typical hosts
+    inline const std::vector<long> kBlockSizes{64, 256, 1024};
+    inline const std::vector<long> kChannelNums{1, 2};
+
+    /**
+     * planar buffers filled with reproducible white noise
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class NoiseBuffers {
+    public:
+        NoiseBuffers(const std::size_t num_channels, const std::size_t num_samples, const FloatType level = FloatType(0.5))
+            : data_(num_channels, std::vector<FloatType>(num_samples)), pointers_(num_channels) {
+            std::mt19937 generator{42};
+            std::uniform_real_distribution<FloatType> distribution{-level, level};
+            for (std::size_t chan = 0; chan < num_channels; ++chan) {
+                for (auto &x: data_[chan]) {
+                    x = distribution(generator);
+                }
+                pointers_[chan] = data_[chan].data();
+            }
+        }
+
+        std::span<FloatType *> getSpan() { return {pointers_.data(), pointers_.size()}; }
+
+        FloatType *getChannel(const std::size_t chan) { return pointers_[chan]; }
+
+    private:
+        std::vector<std::vector<FloatType> > data_;
+        std::vector<FloatType *> pointers_;
+    };
+}
@@ -0,0 +1,140 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+
+#include <benchmark/benchmark.h>
+
+#include "compressor/compressor.hpp"
+#include "benchmark_buffers.hpp"
+
+namespace {
+    /**
+     * the computer, tracker and follower shared by a style
+     */
+    struct CompressorParts {
+        zldsp::compressor::KneeComputer<float> computer;
+        zldsp::compressor::RMSTracker<float> tracker;
+        zldsp::compressor::PSFollower<float> follower;
+
+        CompressorParts() {
+            computer.setThreshold(-18.f);
+            computer.setRatio(4.f);
+            computer.setKneeW(6.f);
+            tracker.setMaximumMomentarySeconds(.5f);
+            tracker.prepare(48000.0);
+            tracker.setMomentarySeconds(.05f);
+            follower.prepare(48000.0);
+            follower.setAttack(10.f);
+            follower.setRelease(100.f);
+            computer.prepareBuffer();
+            tracker.prepareBuffer();
+            follower.prepareBuffer();
+        }
+    };
+
+    /**
+     * a style on one channel of range(0) samples per block
+     * the input is copied in every iteration, since the style turns the block into gains in place
+     * @tparam Style
+     * @tparam UseRMS
+     */
+    template<template<typename> class Style, bool UseRMS>
+    void BM_CompressorStyle(benchmark::State &state) {
+        const auto num_samples = static_cast<size_t>(state.range(0));
+        CompressorParts parts;
+        Style<float> style{parts.computer, parts.tracker, parts.follower};
+        style.reset();
+        zldsp::bench::NoiseBuffers<float> input(1, num_samples);
+        std::vector<float> buffer(num_samples);
+        for (auto _: state) {
+            std::copy(input.getChannel(0), input.getChannel(0) + num_samples, buffer.begin());
+            style.template process<UseRMS>(buffer.data(), num_samples);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_samples));
+    }
+
+    /**
+     * the RMS tracker in mode range(0) on range(1) samples per block
+     */
+    void BM_RMSTracker(benchmark::State &state) {
+        const auto num_samples = static_cast<size_t>(state.range(1));
+        zldsp::compressor::RMSTracker<float> tracker;
+        tracker.setMaximumMomentarySeconds(.5f);
+        tracker.prepare(48000.0);
+        tracker.setMode(static_cast<zldsp::compressor::RMSMode>(state.range(0)));
+        tracker.setMomentarySeconds(.3f);
+        tracker.prepareBuffer();
+        zldsp::bench::NoiseBuffers<float> input(1, num_samples);
+        const auto *samples = input.getChannel(0);
+        for (auto _: state) {
+            for (size_t i = 0; i < num_samples; ++i) {
+                tracker.processSample(samples[i]);
+            }
+            benchmark::DoNotOptimize(tracker.getMomentarySquare());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_samples));
+    }
+
+    /**
+     * the spectral compressor at sample rate range(0) with range(1) bands on two channels of 512 samples per block
+     * the FFT size follows the sample rate, so that the frame rate stays the same
+     */
+    void BM_SpectralCompressor(benchmark::State &state) {
+        constexpr size_t kNumSamples = 512;
+        const auto sample_rate = static_cast<double>(state.range(0));
+        zldsp::compressor::KneeComputer<float, true> computer;
+        computer.setThreshold(-18.f);
+        computer.setRatio(4.f);
+        computer.setKneeW(6.f);
+        computer.prepareBuffer();
+        zldsp::compressor::SpectralCompressor<float> compressor{computer};
+        compressor.prepare(sample_rate, 2, sample_rate > 50000.0 ? 12 : 11, static_cast<size_t>(state.range(1)));
+        compressor.setAttack(10.f);
+        compressor.setRelease(100.f);
+        compressor.prepareBuffer();
+        zldsp::bench::NoiseBuffers<float> input(2, kNumSamples), buffer(2, kNumSamples);
+        for (auto _: state) {
+            for (size_t chan = 0; chan < 2; ++chan) {
+                std::copy(input.getChannel(chan), input.getChannel(chan) + kNumSamples, buffer.getChannel(chan));
+            }
+            compressor.process(buffer.getSpan(), kNumSamples);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kNumSamples));
+    }
+}
+
+BENCHMARK(BM_CompressorStyle<zldsp::compressor::CleanCompressor, false>)
+    ->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+BENCHMARK(BM_CompressorStyle<zldsp::compressor::CleanCompressor, true>)
+    ->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+BENCHMARK(BM_CompressorStyle<zldsp::compressor::ClassicCompressor, false>)
+    ->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+BENCHMARK(BM_CompressorStyle<zldsp::compressor::ClassicCompressor, true>)
+    ->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+BENCHMARK(BM_CompressorStyle<zldsp::compressor::OpticalCompressor, false>)
+    ->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+BENCHMARK(BM_CompressorStyle<zldsp::compressor::OpticalCompressor, true>)
+    ->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+
+BENCHMARK(BM_SpectralCompressor)
+    ->ArgNames({"sample_rate", "bands"})
+    ->Args({48000, 64})
+    ->Args({96000, 256});
+
+BENCHMARK(BM_RMSTracker)
+    ->ArgNames({"mode", "block"})
+    ->ArgsProduct({
+        {zldsp::compressor::RMSMode::kBoxcar, zldsp::compressor::RMSMode::kExponential,
+         zldsp::compressor::RMSMode::kCascade},
+        zldsp::bench::kBlockSizes
+    });
@@ -0,0 +1,111 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <array>
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "container/container.hpp"
+#include "benchmark_buffers.hpp"
+
+namespace {
+    /**
+     * write and read range(0) samples per block through an AbstractFIFO, as the analyzers do
+     */
+    void BM_AbstractFIFO(benchmark::State &state) {
+        const auto num_samples = static_cast<int>(state.range(0));
+        zldsp::container::AbstractFIFO fifo{4096};
+        std::vector<float> storage(4096);
+        zldsp::bench::NoiseBuffers<float> input(1, static_cast<size_t>(num_samples));
+        std::vector<float> output(static_cast<size_t>(num_samples));
+        const auto *source = input.getChannel(0);
+        for (auto _: state) {
+            const auto plan = fifo.planWrite(num_samples);
+            const auto write_range = fifo.prepareToWrite(plan.num_to_write);
+            std::copy(source, source + write_range.block_size1, storage.begin() + write_range.start_index1);
+            std::copy(source + write_range.block_size1, source + plan.num_to_write,
+                      storage.begin() + write_range.start_index2);
+            fifo.finishWrite(plan.num_to_write);
+            const auto num_ready = fifo.getNumReady();
+            const auto read_range = fifo.prepareToRead(num_ready);
+            std::copy(storage.begin() + read_range.start_index1,
+                      storage.begin() + read_range.start_index1 + read_range.block_size1, output.begin());
+            std::copy(storage.begin() + read_range.start_index2,
+                      storage.begin() + read_range.start_index2 + read_range.block_size2,
+                      output.begin() + read_range.block_size1);
+            fifo.finishRead(num_ready);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * num_samples);
+    }
+
+    /**
+     * write range(1) samples of range(0) channels per block to a BroadcastRing and read them back with one reader
+     */
+    void BM_BroadcastRing(benchmark::State &state) {
+        const auto num_channels = static_cast<size_t>(state.range(0));
+        const auto num_samples = static_cast<size_t>(state.range(1));
+        zldsp::container::BroadcastRing<float> ring;
+        ring.prepare(num_channels, 8192);
+        zldsp::container::BroadcastRing<float>::Reader reader{ring};
+        zldsp::bench::NoiseBuffers<float> input(num_channels, num_samples), output(num_channels, num_samples);
+        for (auto _: state) {
+            ring.write(input.getSpan(), num_samples);
+            benchmark::DoNotOptimize(reader.read(output.getSpan(), num_samples));
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_channels * num_samples));
+    }
+
+    /**
+     * push range(0) samples per block through a full CircularBuffer, which drops its oldest sample on each push
+     */
+    void BM_CircularBuffer(benchmark::State &state) {
+        const auto num_samples = static_cast<size_t>(state.range(0));
+        zldsp::container::CircularBuffer<float> buffer{4800};
+        zldsp::bench::NoiseBuffers<float> input(1, num_samples);
+        const auto *samples = input.getChannel(0);
+        for (auto _: state) {
+            for (size_t i = 0; i < num_samples; ++i) {
+                buffer.pushBack(samples[i]);
+            }
+            benchmark::DoNotOptimize(buffer.getFront());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_samples));
+    }
+
+    /**
+     * the running maximum over a window of 4800 samples, range(0) samples per block
+     */
+    void BM_CircularMinMaxBuffer(benchmark::State &state) {
+        const auto num_samples = static_cast<size_t>(state.range(0));
+        zldsp::container::CircularMinMaxBuffer<float, zldsp::container::kFindMax> buffer{4800};
+        buffer.setSize(4800);
+        zldsp::bench::NoiseBuffers<float> input(1, num_samples);
+        const auto *samples = input.getChannel(0);
+        for (auto _: state) {
+            for (size_t i = 0; i < num_samples; ++i) {
+                benchmark::DoNotOptimize(buffer.push(samples[i]));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_samples));
+    }
+}
+
+BENCHMARK(BM_AbstractFIFO)->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+
+BENCHMARK(BM_BroadcastRing)
+    ->ArgNames({"channels", "block"})
+    ->ArgsProduct({zldsp::bench::kChannelNums, zldsp::bench::kBlockSizes});
+
+BENCHMARK(BM_CircularBuffer)->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
+
+BENCHMARK(BM_CircularMinMaxBuffer)->ArgName("block")->ArgsProduct({zldsp::bench::kBlockSizes});
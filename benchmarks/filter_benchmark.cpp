@@ -0,0 +1,47 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <benchmark/benchmark.h>
+
+#include "filter/filter.hpp"
+#include "benchmark_buffers.hpp"
+
+namespace {
+    /**
+     * a Butterworth low-pass with range(0) sections on range(1) channels, range(2) samples per block
+     * @tparam IsSmooth update the coefficients on every sample, as when a parameter is being smoothed
+     */
+    template<bool IsSmooth>
+    void BM_IIRProcess(benchmark::State &state) {
+        const auto num_sections = static_cast<size_t>(state.range(0));
+        const auto num_channels = static_cast<size_t>(state.range(1));
+        const auto num_samples = static_cast<size_t>(state.range(2));
+        zldsp::filter::IIR<float, 16> filter;
+        filter.prepare(48000.0, num_channels);
+        filter.setFilterType(zldsp::filter::FilterType::kLowPass);
+        filter.setOrder(num_sections * 2);
+        filter.setFreq(1000.f);
+        filter.prepareBuffer();
+        zldsp::bench::NoiseBuffers<float> buffers(num_channels, num_samples);
+        for (auto _: state) {
+            filter.template processIIR<false, IsSmooth>(buffers.getSpan(), num_samples);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_channels * num_samples));
+    }
+}
+
+BENCHMARK(BM_IIRProcess<false>)
+    ->ArgNames({"sections", "channels", "block"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, zldsp::bench::kChannelNums, zldsp::bench::kBlockSizes});
+
+BENCHMARK(BM_IIRProcess<true>)
+    ->ArgNames({"sections", "channels", "block"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, zldsp::bench::kChannelNums, zldsp::bench::kBlockSizes});
@@ -0,0 +1,49 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <benchmark/benchmark.h>
+
+#include "over_sample/over_sample.hpp"
+#include "benchmark_buffers.hpp"
+
+namespace {
+    /**
+     * upsample and downsample range(0) channels of range(1) samples per block through NumStage stages
+     * @tparam NumStage
+     */
+    template<size_t NumStage>
+    void BM_OverSampler(benchmark::State &state) {
+        const auto num_channels = static_cast<size_t>(state.range(0));
+        const auto num_samples = static_cast<size_t>(state.range(1));
+        zldsp::oversample::OverSampler<float, NumStage> over_sampler;
+        over_sampler.prepare(num_channels, num_samples);
+        zldsp::bench::NoiseBuffers<float> buffers(num_channels, num_samples);
+        for (auto _: state) {
+            over_sampler.process(buffers.getSpan(), num_samples,
+                                 [](std::span<float *> os_buffer, size_t) {
+                                     benchmark::DoNotOptimize(os_buffer.data());
+                                 });
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_channels * num_samples));
+    }
+}
+
+#define ZLDSP_BENCHMARK_OVER_SAMPLER(NumStage) \
+    BENCHMARK(BM_OverSampler<NumStage>) \
+        ->ArgNames({"channels", "block"}) \
+        ->ArgsProduct({zldsp::bench::kChannelNums, zldsp::bench::kBlockSizes})
+
+ZLDSP_BENCHMARK_OVER_SAMPLER(1);
+ZLDSP_BENCHMARK_OVER_SAMPLER(2);
+ZLDSP_BENCHMARK_OVER_SAMPLER(3);
+ZLDSP_BENCHMARK_OVER_SAMPLER(4);
+ZLDSP_BENCHMARK_OVER_SAMPLER(5);
+ZLDSP_BENCHMARK_OVER_SAMPLER(6);
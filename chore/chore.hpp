@@ -11,3 +11,5 @@
 
 #include "smoothed_value.hpp"
 #include "decibels.hpp"
+#include "realtime_check.hpp"
+#include "cycle_counter.hpp"
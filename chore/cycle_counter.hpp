@@ -0,0 +1,299 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#if defined(ZLDSP_ENABLE_CYCLE_COUNTER)
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ZLDSP_CYCLE_COUNTER_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define ZLDSP_CYCLE_COUNTER_RDTSC 1
+#endif
+
+namespace zldsp::chore {
+    /**
+     * @return the current tick, CPU cycles on x86, steady clock nanoseconds otherwise
+     */
+    inline std::uint64_t getTicks() {
+#if defined(ZLDSP_CYCLE_COUNTER_RDTSC)
+        return static_cast<std::uint64_t>(__rdtsc());
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * a fixed-size lock-free histogram of ticks per call, grouped by block size
+     * the writer is the audio thread, the reader can be any thread
+     * ticks are bucketed with 4 buckets per octave, block sizes are grouped by octave
+     */
+    class CycleHistogram {
+    public:
+        static constexpr size_t kBlockClassNum = 16;
+        static constexpr size_t kOctaveNum = 40;
+        static constexpr size_t kBucketPerOctave = 4;
+        static constexpr size_t kBucketNum = kOctaveNum * kBucketPerOctave;
+
+        struct Stats {
+            std::uint64_t count;
+            std::uint64_t p50, p99, max;
+        };
+
+        CycleHistogram() = default;
+
+        [[nodiscard]] const char *getName() const { return name_.load(std::memory_order::relaxed); }
+
+        /**
+         * @return the instance which owns the histogram, to tell the instances of the same function apart
+         */
+        [[nodiscard]] const void *getOwner() const { return owner_.load(std::memory_order::relaxed); }
+
+        void setName(const char *name, const void *owner) {
+            name_.store(name, std::memory_order::relaxed);
+            owner_.store(owner, std::memory_order::relaxed);
+        }
+
+        /**
+         * record a call, wait-free
+         * @param num_samples the block size of the call
+         * @param ticks the ticks spent in the call
+         */
+        void record(const size_t num_samples, const std::uint64_t ticks) {
+            const auto block_class = getBlockClass(num_samples);
+            buckets_[block_class][getBucket(ticks)].fetch_add(1, std::memory_order::relaxed);
+            auto &max_ticks{max_ticks_[block_class]};
+            auto pre_max = max_ticks.load(std::memory_order::relaxed);
+            while (ticks > pre_max && !max_ticks.compare_exchange_weak(pre_max, ticks, std::memory_order::relaxed)) {
+            }
+        }
+
+        /**
+         * @param block_class block sizes in [2^block_class, 2^(block_class+1))
+         * @return the count, the p50/p99 upper bucket bounds and the max ticks
+         */
+        [[nodiscard]] Stats getStats(const size_t block_class) const {
+            std::array<std::uint64_t, kBucketNum> counts{};
+            std::uint64_t total{0};
+            for (size_t i = 0; i < kBucketNum; ++i) {
+                counts[i] = buckets_[block_class][i].load(std::memory_order::relaxed);
+                total += counts[i];
+            }
+            Stats stats{total, 0, 0, max_ticks_[block_class].load(std::memory_order::relaxed)};
+            if (total == 0) return stats;
+            const auto p50_count = (total + 1) / 2, p99_count = (total * 99 + 99) / 100;
+            std::uint64_t cumulative{0};
+            for (size_t i = 0; i < kBucketNum; ++i) {
+                const auto pre_cumulative = cumulative;
+                cumulative += counts[i];
+                if (pre_cumulative < p50_count && cumulative >= p50_count) {
+                    stats.p50 = std::min(getBucketUpperBound(i), stats.max);
+                }
+                if (pre_cumulative < p99_count && cumulative >= p99_count) {
+                    stats.p99 = std::min(getBucketUpperBound(i), stats.max);
+                    break;
+                }
+            }
+            return stats;
+        }
+
+        /**
+         * clear all records, the result is undefined if the writer records at the same time
+         */
+        void clear() {
+            for (auto &block_buckets: buckets_) {
+                for (auto &bucket: block_buckets) {
+                    bucket.store(0, std::memory_order::relaxed);
+                }
+            }
+            for (auto &max_ticks: max_ticks_) {
+                max_ticks.store(0, std::memory_order::relaxed);
+            }
+        }
+
+        static size_t getBlockClass(const size_t num_samples) {
+            const auto block_class = static_cast<size_t>(std::bit_width(num_samples | 1)) - 1;
+            return std::min(block_class, kBlockClassNum - 1);
+        }
+
+    private:
+        std::atomic<const char *> name_{""};
+        std::atomic<const void *> owner_{nullptr};
+        std::array<std::array<std::atomic<std::uint64_t>, kBucketNum>, kBlockClassNum> buckets_{};
+        std::array<std::atomic<std::uint64_t>, kBlockClassNum> max_ticks_{};
+
+        static size_t getBucket(const std::uint64_t ticks) {
+            if (ticks < kBucketPerOctave) return static_cast<size_t>(ticks);
+            const auto octave = static_cast<size_t>(std::bit_width(ticks)) - 1;
+            const auto fraction = static_cast<size_t>(ticks >> (octave - 2)) & (kBucketPerOctave - 1);
+            return std::min(octave * kBucketPerOctave + fraction, kBucketNum - 1);
+        }
+
+        static std::uint64_t getBucketUpperBound(const size_t bucket) {
+            if (bucket < kBucketPerOctave) return static_cast<std::uint64_t>(bucket);
+            const auto octave = bucket / kBucketPerOctave;
+            const auto fraction = static_cast<std::uint64_t>(bucket % kBucketPerOctave);
+            return ((kBucketPerOctave + fraction + 1) << (octave - 2)) - 1;
+        }
+    };
+
+    /**
+     * a fixed-size lock-free pool of histograms
+     * the histograms live as long as the program, so the reader never sees a dangling one
+     * a released slot may be acquired again by another counter, the reader then sees it restart
+     */
+    class CycleCounterRegistry {
+    public:
+        static constexpr size_t kMaxHistogramNum = 256;
+
+        static CycleCounterRegistry &getInstance() {
+            static CycleCounterRegistry registry;
+            return registry;
+        }
+
+        /**
+         * acquire a free histogram and clear it, not real-time safe
+         * @param name the qualified name of the counted function
+         * @param owner the instance which owns the counter
+         * @return the histogram, nullptr if the pool is full
+         */
+        CycleHistogram *acquire(const char *name, const void *owner) {
+            for (size_t idx = 0; idx < kMaxHistogramNum; ++idx) {
+                bool expected{false};
+                if (in_use_[idx].compare_exchange_strong(expected, true, std::memory_order::acquire)) {
+                    auto &histogram{histograms_[idx]};
+                    histogram.clear();
+                    histogram.setName(name, owner);
+                    published_[idx].store(true, std::memory_order::release);
+                    return &histogram;
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * release a histogram returned by acquire
+         * @param histogram
+         */
+        void release(CycleHistogram *histogram) {
+            const auto idx = static_cast<size_t>(histogram - histograms_.data());
+            published_[idx].store(false, std::memory_order::relaxed);
+            in_use_[idx].store(false, std::memory_order::release);
+        }
+
+        [[nodiscard]] static constexpr size_t size() { return kMaxHistogramNum; }
+
+        /**
+         * @param idx
+         * @return the histogram at idx, nullptr if the slot is free
+         */
+        [[nodiscard]] const CycleHistogram *get(const size_t idx) const {
+            return published_[idx].load(std::memory_order::acquire) ? &histograms_[idx] : nullptr;
+        }
+
+    private:
+        std::array<CycleHistogram, kMaxHistogramNum> histograms_{};
+        std::array<std::atomic<bool>, kMaxHistogramNum> in_use_{};
+        std::array<std::atomic<bool>, kMaxHistogramNum> published_{};
+
+        CycleCounterRegistry() = default;
+    };
+
+    /**
+     * the per-instance counter of a function, a member of the module which owns the function
+     * it acquires a histogram in prepare, so that nothing is registered on the audio thread
+     * a copy is not registered until it is prepared
+     */
+    class CycleCounter {
+    public:
+        CycleCounter() = default;
+
+        CycleCounter(const CycleCounter &) {
+        }
+
+        CycleCounter &operator=(const CycleCounter &) { return *this; }
+
+        ~CycleCounter() {
+            if (histogram_ != nullptr) {
+                CycleCounterRegistry::getInstance().release(histogram_);
+            }
+        }
+
+        /**
+         * register the counter, call it before processing starts
+         * @param name the qualified name of the counted function
+         * @param owner the instance which owns the counter
+         */
+        void prepare(const char *name, const void *owner) {
+            if (histogram_ == nullptr) {
+                histogram_ = CycleCounterRegistry::getInstance().acquire(name, owner);
+            }
+        }
+
+        [[nodiscard]] CycleHistogram *getHistogram() const { return histogram_; }
+
+    private:
+        CycleHistogram *histogram_{nullptr};
+    };
+
+    /**
+     * an RAII counter which records the ticks between construction and destruction
+     */
+    class ScopedCycleCounter {
+    public:
+        ScopedCycleCounter(const CycleCounter &counter, const size_t num_samples)
+            : histogram_(counter.getHistogram()), num_samples_(num_samples), start_(getTicks()) {
+        }
+
+        ~ScopedCycleCounter() {
+            if (histogram_ != nullptr) {
+                histogram_->record(num_samples_, getTicks() - start_);
+            }
+        }
+
+        ScopedCycleCounter(const ScopedCycleCounter &) = delete;
+
+        ScopedCycleCounter &operator=(const ScopedCycleCounter &) = delete;
+
+    private:
+        CycleHistogram *histogram_;
+        size_t num_samples_;
+        std::uint64_t start_;
+    };
+}
+
+#define ZLDSP_CYCLE_COUNTER(counter, num_samples) \
+    const zldsp::chore::ScopedCycleCounter zldsp_cycle_counter{counter, static_cast<size_t>(num_samples)}
+
+#else
+
+namespace zldsp::chore {
+    /**
+     * an empty counter, so that the members and the prepare calls compile away
+     */
+    class CycleCounter {
+    public:
+        void prepare(const char *, const void *) {
+        }
+    };
+}
+
+#define ZLDSP_CYCLE_COUNTER(counter, num_samples)
+
+#endif
@@ -0,0 +1,181 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+// Interceptors for the real-time checker. Compile this file into debug builds only,
+// together with ZLDSP_ENABLE_REALTIME_CHECK defined for every translation unit.
+// - glibc: malloc/free family and pthread_mutex_lock are interposed, which also covers operator new/delete
+// - others: the global operator new/delete are replaced
+
+#include "realtime_check.hpp"
+
+#if defined(ZLDSP_ENABLE_REALTIME_CHECK)
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <new>
+
+#if defined(__GLIBC__)
+
+#include <dlfcn.h>
+#include <pthread.h>
+
+extern "C" {
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t num, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *ptr);
+
+    void *malloc(size_t size) {
+        zldsp::chore::checkRealTime("malloc");
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t num, size_t size) {
+        zldsp::chore::checkRealTime("calloc");
+        return __libc_calloc(num, size);
+    }
+
+    void *realloc(void *ptr, size_t size) {
+        zldsp::chore::checkRealTime("realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void *memalign(size_t alignment, size_t size) {
+        zldsp::chore::checkRealTime("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size) {
+        zldsp::chore::checkRealTime("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void **ptr, size_t alignment, size_t size) {
+        zldsp::chore::checkRealTime("posix_memalign");
+        *ptr = __libc_memalign(alignment, size);
+        return *ptr == nullptr ? ENOMEM : 0;
+    }
+
+    void free(void *ptr) {
+        if (ptr != nullptr) {
+            zldsp::chore::checkRealTime("free");
+        }
+        __libc_free(ptr);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t *mutex) {
+        using LockFunc = int (*)(pthread_mutex_t *);
+        // std::call_once would lock a mutex itself, threads which race here store the same pointer
+        static std::atomic<LockFunc> real_lock{nullptr};
+        auto lock_func = real_lock.load(std::memory_order::acquire);
+        if (lock_func == nullptr) {
+            ZLDSP_NON_REALTIME_SCOPE();
+            lock_func = reinterpret_cast<LockFunc>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            real_lock.store(lock_func, std::memory_order::release);
+        }
+        zldsp::chore::checkRealTime("pthread_mutex_lock");
+        return lock_func(mutex);
+    }
+}
+
+#else
+
+#include <cstdlib>
+
+namespace {
+    void *allocate(const std::size_t size) {
+        zldsp::chore::checkRealTime("operator new");
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *allocateAligned(const std::size_t size, const std::align_val_t alignment) {
+        zldsp::chore::checkRealTime("operator new");
+        const auto align = static_cast<std::size_t>(alignment);
+        void *raw = std::malloc(size + align + sizeof(void *));
+        if (raw == nullptr) return nullptr;
+        auto address = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *);
+        address = (address + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+        reinterpret_cast<void **>(address)[-1] = raw;
+        return reinterpret_cast<void *>(address);
+    }
+
+    void deallocate(void *ptr) {
+        if (ptr == nullptr) return;
+        zldsp::chore::checkRealTime("operator delete");
+        std::free(ptr);
+    }
+
+    void deallocateAligned(void *ptr) {
+        if (ptr == nullptr) return;
+        zldsp::chore::checkRealTime("operator delete");
+        std::free(reinterpret_cast<void **>(ptr)[-1]);
+    }
+}
+
+void *operator new(const std::size_t size) {
+    if (void *ptr = allocate(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](const std::size_t size) {
+    if (void *ptr = allocate(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void *operator new(const std::size_t size, const std::align_val_t alignment) {
+    if (void *ptr = allocateAligned(size, alignment)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](const std::size_t size, const std::align_val_t alignment) {
+    if (void *ptr = allocateAligned(size, alignment)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void *operator new[](const std::size_t size, const std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept { deallocate(ptr); }
+
+void operator delete[](void *ptr) noexcept { deallocate(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { deallocate(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { deallocate(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { deallocate(ptr); }
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { deallocate(ptr); }
+
+void operator delete(void *ptr, std::align_val_t) noexcept { deallocateAligned(ptr); }
+
+void operator delete[](void *ptr, std::align_val_t) noexcept { deallocateAligned(ptr); }
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { deallocateAligned(ptr); }
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { deallocateAligned(ptr); }
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { deallocateAligned(ptr); }
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { deallocateAligned(ptr); }
+
+#endif
+
+#endif
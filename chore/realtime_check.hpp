@@ -0,0 +1,147 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#if defined(ZLDSP_ENABLE_REALTIME_CHECK)
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+namespace zldsp::chore {
+    /**
+     * the callback which is invoked when a real-time violation happens
+     * @param what the name of the violating call, e.g. "malloc"
+     * @param scope the name of the innermost real-time scope
+     */
+    using RealTimeViolationHandler = void (*)(const char *what, const char *scope);
+
+    namespace realtime_check {
+        struct ThreadState {
+            int depth{0};
+            int suspended{0};
+            const char *scope{nullptr};
+        };
+
+        inline ThreadState &getThreadState() {
+            // in an executable, initial-exec avoids the lazy TLS allocation, which would re-enter the malloc
+            // interceptor; a shared library keeps the default model, as a library loaded by dlopen may not find
+            // room in the static TLS block (the interceptors are compiled into the executable anyway)
+#if defined(__GNUC__) && (!defined(__PIC__) || defined(__PIE__))
+            [[gnu::tls_model("initial-exec")]]
+#endif
+            static thread_local ThreadState state;
+            return state;
+        }
+
+        /**
+         * print the violation and the current stack to stderr, then abort
+         */
+        inline void defaultHandler(const char *what, const char *scope) {
+            std::fprintf(stderr, "zldsp: real-time violation: %s inside %s\n", what, scope);
+#if defined(__GLIBC__) || defined(__APPLE__)
+            void *frames[64];
+            const int num_frames = backtrace(frames, 64);
+            backtrace_symbols_fd(frames, num_frames, STDERR_FILENO);
+#endif
+            std::abort();
+        }
+
+        inline std::atomic<RealTimeViolationHandler> &getHandler() {
+            static std::atomic<RealTimeViolationHandler> handler{defaultHandler};
+            return handler;
+        }
+    }
+
+    /**
+     * set the violation handler, the default one prints the stack and aborts
+     * @param handler
+     */
+    inline void setRealTimeViolationHandler(const RealTimeViolationHandler handler) {
+        realtime_check::getHandler().store(handler == nullptr ? realtime_check::defaultHandler : handler);
+    }
+
+    /**
+     * @return whether the current thread is inside a real-time scope
+     */
+    inline bool isInRealTimeScope() {
+        const auto &state = realtime_check::getThreadState();
+        return state.depth > 0 && state.suspended == 0;
+    }
+
+    /**
+     * report a violation if the current thread is inside a real-time scope
+     * the checks are suspended while the handler runs, so the handler may allocate
+     * @param what the name of the violating call
+     */
+    inline void checkRealTime(const char *what) {
+        auto &state = realtime_check::getThreadState();
+        if (state.depth == 0 || state.suspended > 0) return;
+        state.suspended += 1;
+        realtime_check::getHandler().load()(what, state.scope);
+        state.suspended -= 1;
+    }
+
+    /**
+     * an RAII scope which marks the current thread as real-time
+     * scopes can be nested, the innermost name is reported
+     */
+    class RealTimeScope {
+    public:
+        explicit RealTimeScope(const char *name) {
+            auto &state = realtime_check::getThreadState();
+            pre_scope_ = state.scope;
+            state.scope = name;
+            state.depth += 1;
+        }
+
+        ~RealTimeScope() {
+            auto &state = realtime_check::getThreadState();
+            state.depth -= 1;
+            state.scope = pre_scope_;
+        }
+
+        RealTimeScope(const RealTimeScope &) = delete;
+
+        RealTimeScope &operator=(const RealTimeScope &) = delete;
+
+    private:
+        const char *pre_scope_;
+    };
+
+    /**
+     * an RAII scope which suspends the checks, e.g. around deliberate non-real-time work
+     */
+    class NonRealTimeScope {
+    public:
+        NonRealTimeScope() { realtime_check::getThreadState().suspended += 1; }
+
+        ~NonRealTimeScope() { realtime_check::getThreadState().suspended -= 1; }
+
+        NonRealTimeScope(const NonRealTimeScope &) = delete;
+
+        NonRealTimeScope &operator=(const NonRealTimeScope &) = delete;
+    };
+}
+
+#define ZLDSP_REALTIME_SCOPE(name) const zldsp::chore::RealTimeScope zldsp_realtime_scope{name}
+#define ZLDSP_NON_REALTIME_SCOPE() const zldsp::chore::NonRealTimeScope zldsp_non_realtime_scope{}
+
+#else
+
+#define ZLDSP_REALTIME_SCOPE(name)
+#define ZLDSP_NON_REALTIME_SCOPE()
+
+#endif
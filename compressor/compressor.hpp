@@ -13,3 +13,5 @@
 #include "tracker/tracker.hpp"
 #include "follower/follower.hpp"
 #include "styles/styles.hpp"
+#include "spectral/spectral.hpp"
+#include "dynamic/dynamic.hpp"
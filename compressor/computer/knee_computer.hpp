@@ -13,6 +13,7 @@
 #include <vector>
 #include <array>
 #include <algorithm>
+#include <span>
 
 #include "computer_base.hpp"
 
@@ -52,6 +53,29 @@ namespace zldsp::compressor {
             }
         }
 
+        /**
+         * evaluate a block without branches, so that the loop vectorizes, e.g. across the bands of a multiband compressor
+         * the segments are blended with 0/1 masks, since selects of computed values are not if-converted under trapping math
+         * @param xs
+         * @param ys receives the computer function values at xs, may be xs itself
+         */
+        void eval(std::span<const FloatType> xs, std::span<FloatType> ys) const {
+            const auto low_th = low_th_, high_th = high_th_;
+            const auto mid0 = para_mid_g0_[0], mid1 = para_mid_g0_[1], mid2 = para_mid_g0_[2];
+            const auto high0 = para_high_g0_[0], high1 = para_high_g0_[1], high2 = para_high_g0_[2];
+            for (size_t i = 0; i < xs.size(); ++i) {
+                const auto x = xs[i];
+                const auto xh = std::min(x, FloatType(0));
+                const auto low = OutputDiff ? FloatType(0) : x;
+                const auto mid = (mid0 * x + mid1) * x + mid2;
+                const auto high = (high0 * xh + high1) * xh + high2;
+                const auto is_low = static_cast<FloatType>(x <= low_th);
+                const auto is_high = static_cast<FloatType>(x >= high_th);
+                const auto y = mid + is_high * (high - mid);
+                ys[i] = y + is_low * (low - y);
+            }
+        }
+
         inline void setThreshold(FloatType v) {
             threshold_.store(v, std::memory_order::relaxed);
             to_interpolate_.store(true, std::memory_order::release);
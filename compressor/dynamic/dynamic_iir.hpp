@@ -0,0 +1,325 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include "../computer/computer.hpp"
+#include "../follower/follower.hpp"
+#include "../../filter/helpers.hpp"
+#include "../../chore/realtime_check.hpp"
+#include "../../chore/cycle_counter.hpp"
+
+namespace zldsp::compressor {
+    /**
+     * a bank of dynamic EQ bands, each one a peak / low shelf / high shelf biquad in series
+     * the sections are the bilinear (RBJ) designs, whose frequency terms are computed when a parameter changes,
+     * so that once per control block only the gain-dependent terms are re-run with the new band gain,
+     * and the coefficients ramp linearly to them over the next control block
+     * the gain of a band is exact at its centre (peak), at DC (low shelf) or at Nyquist (high shelf)
+     * the detector of a band is a separate bandpass (peak) or 2nd-order lowpass / highpass (shelves) on the input,
+     * its mean square (linked across channels) is taken over each control block and passes through the band
+     * computer and follower at the control rate
+     * the detectors and the coefficient updates work on separate arrays, so they vectorize across bands
+     * @tparam FloatType
+     * @tparam BandNum the number of bands
+     */
+    template<typename FloatType, size_t BandNum>
+    class DynamicIIR {
+    public:
+        static constexpr size_t kControlSize = 32;
+
+        DynamicIIR() {
+            for (size_t b = 0; b < BandNum; ++b) {
+                freqs_[b].store(1000.0, std::memory_order::relaxed);
+                qs_[b].store(0.707, std::memory_order::relaxed);
+            }
+        }
+
+        /**
+         * call before processing starts
+         * @param sr sample rate
+         * @param num_channels
+         */
+        void prepare(const double sr, const size_t num_channels) {
+            process_counter_.prepare("zldsp::compressor::DynamicIIR::process", this);
+            sample_rate_ = sr;
+            s1_.resize(num_channels);
+            s2_.resize(num_channels);
+            d1_.resize(num_channels);
+            d2_.resize(num_channels);
+            for (auto &f: followers_) {
+                f.prepare(sr / static_cast<double>(kControlSize));
+            }
+            to_update_para_.store(true, std::memory_order::release);
+            reset();
+        }
+
+        void reset() {
+            for (auto *states: {&s1_, &s2_, &d1_, &d2_}) {
+                for (auto &s: *states) {
+                    std::fill(s.begin(), s.end(), FloatType(0));
+                }
+            }
+            std::fill(powers_.begin(), powers_.end(), FloatType(0));
+            // start from unity sections, the first control block ramps to the band gains
+            for (auto &c: coeffs_) {
+                std::fill(c.begin(), c.end(), FloatType(0));
+            }
+            std::fill(coeffs_[0].begin(), coeffs_[0].end(), FloatType(1));
+            for (auto &c: coeff_steps_) {
+                std::fill(c.begin(), c.end(), FloatType(0));
+            }
+            std::fill(reductions_.begin(), reductions_.end(), FloatType(0));
+            for (auto &f: followers_) {
+                f.reset(FloatType(0));
+            }
+            control_pos_ = 0;
+        }
+
+        /**
+         * update values before processing a buffer
+         */
+        void prepareBuffer() {
+            for (size_t b = 0; b < BandNum; ++b) {
+                computers_[b].prepareBuffer();
+                followers_[b].prepareBuffer();
+            }
+            if (to_update_para_.exchange(false, std::memory_order::acquire)) {
+                for (size_t b = 0; b < BandNum; ++b) {
+                    updateCoeff(b);
+                    static_gains_[b] = gains_[b].load(std::memory_order::relaxed);
+                    is_on_[b] = band_on_[b].load(std::memory_order::relaxed);
+                }
+            }
+        }
+
+        void process(std::span<FloatType *> buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::DynamicIIR::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            auto &[b0, b1, b2, a1, a2] = coeffs_;
+            for (size_t i = 0; i < num_samples; ++i) {
+                for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                    const auto x = buffer[chan][i];
+                    // detectors, in parallel on the input
+                    auto &d1{d1_[chan]};
+                    auto &d2{d2_[chan]};
+                    for (size_t b = 0; b < BandNum; ++b) {
+                        const auto d = db0_[b] * x + d1[b];
+                        d1[b] = db1_[b] * x - da1_[b] * d + d2[b];
+                        d2[b] = db2_[b] * x - da2_[b] * d;
+                        powers_[b] += d * d;
+                    }
+                    // bands, in series
+                    auto &s1{s1_[chan]};
+                    auto &s2{s2_[chan]};
+                    auto y = x;
+                    for (size_t b = 0; b < BandNum; ++b) {
+                        const auto z = b0[b] * y + s1[b];
+                        s1[b] = b1[b] * y - a1[b] * z + s2[b];
+                        s2[b] = b2[b] * y - a2[b] * z;
+                        y = z;
+                    }
+                    buffer[chan][i] = y;
+                }
+                for (size_t k = 0; k < kCoeffNum; ++k) {
+                    for (size_t b = 0; b < BandNum; ++b) {
+                        coeffs_[k][b] += coeff_steps_[k][b];
+                    }
+                }
+                control_pos_ += 1;
+                if (control_pos_ == kControlSize) {
+                    updateGains(buffer.size());
+                    control_pos_ = 0;
+                }
+            }
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @param band
+         * @param x kPeak, kLowShelf or kHighShelf, other types are treated as kPeak
+         */
+        void setFilterType(const size_t band, const filter::FilterType x) {
+            filter_types_[band].store(x, std::memory_order::relaxed);
+            to_update_para_.store(true, std::memory_order::release);
+        }
+
+        void setFreq(const size_t band, const double x) {
+            freqs_[band].store(x, std::memory_order::relaxed);
+            to_update_para_.store(true, std::memory_order::release);
+        }
+
+        void setQ(const size_t band, const double x) {
+            qs_[band].store(x, std::memory_order::relaxed);
+            to_update_para_.store(true, std::memory_order::release);
+        }
+
+        /**
+         * @param band
+         * @param x the static gain in dB, the dynamic gain is added on top of it
+         */
+        void setGain(const size_t band, const FloatType x) {
+            gains_[band].store(x, std::memory_order::relaxed);
+            to_update_para_.store(true, std::memory_order::release);
+        }
+
+        void setBandOn(const size_t band, const bool x) {
+            band_on_[band].store(x, std::memory_order::relaxed);
+            to_update_para_.store(true, std::memory_order::release);
+        }
+
+        KneeComputer<FloatType, true> &getComputer(const size_t band) { return computers_[band]; }
+
+        PSFollower<FloatType> &getFollower(const size_t band) { return followers_[band]; }
+
+        /**
+         * thread-safe, lock-free
+         * @param band
+         * @return the gain in dB the band has ramped to by the end of the current control block
+         */
+        FloatType getBandGainDB(const size_t band) const {
+            return band_gain_dbs_[band].load(std::memory_order::relaxed);
+        }
+
+    private:
+        static constexpr size_t kCoeffNum = 5;
+
+        double sample_rate_{48000.0};
+        chore::CycleCounter process_counter_;
+        std::array<KneeComputer<FloatType, true>, BandNum> computers_;
+        std::array<PSFollower<FloatType>, BandNum> followers_;
+
+        // normalized biquad coefficients b0, b1, b2, a1, a2 of each band and their per-sample increments
+        std::array<std::array<FloatType, BandNum>, kCoeffNum> coeffs_{}, coeff_steps_{};
+        std::vector<std::array<FloatType, BandNum> > s1_, s2_;
+        // the gain-independent terms of each band
+        std::array<filter::FilterType, BandNum> c_filter_types_{};
+        std::array<FloatType, BandNum> cos_w0s_{}, alphas_{};
+
+        // normalized biquad coefficients and states of the detectors
+        std::array<FloatType, BandNum> db0_{}, db1_{}, db2_{}, da1_{}, da2_{};
+        std::vector<std::array<FloatType, BandNum> > d1_, d2_;
+
+        std::array<FloatType, BandNum> powers_{}, reductions_{}, static_gains_{};
+        std::array<bool, BandNum> is_on_{};
+        size_t control_pos_{0};
+        std::array<std::atomic<FloatType>, BandNum> band_gain_dbs_{};
+
+        std::array<std::atomic<filter::FilterType>, BandNum> filter_types_{};
+        std::array<std::atomic<double>, BandNum> freqs_{}, qs_{};
+        std::array<std::atomic<FloatType>, BandNum> gains_{};
+        std::array<std::atomic<bool>, BandNum> band_on_{};
+        std::atomic<bool> to_update_para_{true};
+
+        void updateCoeff(const size_t b) {
+            const auto w0 = filter::ppi * std::clamp(freqs_[b].load(std::memory_order::relaxed),
+                                                     10.0, sample_rate_ * 0.499) / sample_rate_;
+            const auto q = std::max(qs_[b].load(std::memory_order::relaxed), 0.025);
+            const auto cos_w0 = std::cos(w0);
+            const auto alpha = std::sin(w0) / (2.0 * q);
+            auto filter_type = filter_types_[b].load(std::memory_order::relaxed);
+            if (filter_type != filter::FilterType::kLowShelf && filter_type != filter::FilterType::kHighShelf) {
+                filter_type = filter::FilterType::kPeak;
+            }
+            c_filter_types_[b] = filter_type;
+            cos_w0s_[b] = static_cast<FloatType>(cos_w0);
+            alphas_[b] = static_cast<FloatType>(alpha);
+            // the detector: a bandpass with 0 dB at the centre, or a lowpass / highpass at the shelf frequency
+            std::array<double, 3> num{};
+            switch (filter_type) {
+                case filter::FilterType::kLowShelf: {
+                    num = {0.5 * (1.0 - cos_w0), 1.0 - cos_w0, 0.5 * (1.0 - cos_w0)};
+                    break;
+                }
+                case filter::FilterType::kHighShelf: {
+                    num = {0.5 * (1.0 + cos_w0), -1.0 - cos_w0, 0.5 * (1.0 + cos_w0)};
+                    break;
+                }
+                default: {
+                    num = {alpha, 0.0, -alpha};
+                }
+            }
+            const auto a0_inv = 1.0 / (1.0 + alpha);
+            db0_[b] = static_cast<FloatType>(num[0] * a0_inv);
+            db1_[b] = static_cast<FloatType>(num[1] * a0_inv);
+            db2_[b] = static_cast<FloatType>(num[2] * a0_inv);
+            da1_[b] = static_cast<FloatType>(-2.0 * cos_w0 * a0_inv);
+            da2_[b] = static_cast<FloatType>((1.0 - alpha) * a0_inv);
+        }
+
+        void updateGains(const size_t num_channels) {
+            const auto power_scale = FloatType(1) / static_cast<FloatType>(kControlSize * std::max(
+                                                                              num_channels, static_cast<size_t>(1)));
+            std::array<FloatType, BandNum> sqrt_as{};
+            for (size_t b = 0; b < BandNum; ++b) {
+                const auto db = FloatType(10) * std::log10(std::max(powers_[b] * power_scale, FloatType(1e-12)));
+                reductions_[b] = followers_[b].processSample(-computers_[b].eval(db));
+                powers_[b] = FloatType(0);
+                const auto gain_db = is_on_[b] ? static_gains_[b] - reductions_[b] : FloatType(0);
+                band_gain_dbs_[b].store(gain_db, std::memory_order::relaxed);
+                // sqrt(A) with A = 10^(dB / 40)
+                sqrt_as[b] = std::pow(FloatType(10), gain_db * FloatType(0.0125));
+            }
+            // re-run the gain-dependent terms, the targets are reached at the end of the next control block
+            constexpr auto kControlSizeR = FloatType(1) / static_cast<FloatType>(kControlSize);
+            for (size_t b = 0; b < BandNum; ++b) {
+                const auto target = getCoeff(b, sqrt_as[b]);
+                for (size_t k = 0; k < kCoeffNum; ++k) {
+                    coeff_steps_[k][b] = (target[k] - coeffs_[k][b]) * kControlSizeR;
+                }
+            }
+        }
+
+        /**
+         * the RBJ peak / shelf coefficients from the precomputed frequency terms
+         * @param b
+         * @param sqrt_a the square root of A, the band gain is A^2
+         * @return normalized b0, b1, b2, a1, a2
+         */
+        std::array<FloatType, kCoeffNum> getCoeff(const size_t b, const FloatType sqrt_a) const {
+            const auto a = sqrt_a * sqrt_a;
+            const auto cos_w0 = cos_w0s_[b], alpha = alphas_[b];
+            switch (c_filter_types_[b]) {
+                case filter::FilterType::kLowShelf:
+                case filter::FilterType::kHighShelf: {
+                    // the high shelf mirrors the low shelf with cos(w0) -> -cos(w0) and b1, a1 -> -b1, -a1
+                    const auto sign = c_filter_types_[b] == filter::FilterType::kLowShelf ? FloatType(1) : FloatType(-1);
+                    const auto c = sign * cos_w0;
+                    const auto k = FloatType(2) * sqrt_a * alpha;
+                    const auto a0_inv = FloatType(1) / ((a + 1) + (a - 1) * c + k);
+                    return {
+                        a * ((a + 1) - (a - 1) * c + k) * a0_inv,
+                        sign * FloatType(2) * a * ((a - 1) - (a + 1) * c) * a0_inv,
+                        a * ((a + 1) - (a - 1) * c - k) * a0_inv,
+                        sign * FloatType(-2) * ((a - 1) + (a + 1) * c) * a0_inv,
+                        ((a + 1) + (a - 1) * c - k) * a0_inv
+                    };
+                }
+                default: {
+                    const auto a0_inv = FloatType(1) / (FloatType(1) + alpha / a);
+                    return {
+                        (FloatType(1) + alpha * a) * a0_inv,
+                        FloatType(-2) * cos_w0 * a0_inv,
+                        (FloatType(1) - alpha * a) * a0_inv,
+                        FloatType(-2) * cos_w0 * a0_inv,
+                        (FloatType(1) - alpha / a) * a0_inv
+                    };
+                }
+            }
+        }
+    };
+}
@@ -13,6 +13,7 @@
 #include <numbers>
 #include <cmath>
 #include <algorithm>
+#include <span>
 
 #include "follower_base.hpp"
 
@@ -117,6 +118,20 @@ namespace zldsp::compressor {
             return y_;
         }
 
+        /**
+         * run the attack/release of this follower on separate states, e.g. one per band, without branches
+         * smooth and pump-punch are not applied
+         * @param xs the inputs
+         * @param ys the states, updated in place
+         */
+        void processStates(std::span<const FloatType> xs, std::span<FloatType> ys) const {
+            const auto attack = attack_, release = release_;
+            for (size_t k = 0; k < xs.size(); ++k) {
+                const auto x = xs[k], y = ys[k];
+                ys[k] = (x >= y ? attack : release) * (y - x) + x;
+            }
+        }
+
         void setAttack(const FloatType millisecond) {
             attack_time_.store(std::max(FloatType(0), millisecond), std::memory_order::relaxed);
             to_update_.store(true, std::memory_order::release);
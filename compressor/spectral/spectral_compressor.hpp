@@ -0,0 +1,250 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "../computer/computer.hpp"
+#include "../follower/follower.hpp"
+#include "../../fft/fft.hpp"
+#include "../../chore/realtime_check.hpp"
+#include "../../chore/cycle_counter.hpp"
+
+namespace zldsp::compressor {
+    /**
+     * a multiband compressor in the STFT domain
+     * FFT bins are grouped into log-spaced bands, the band powers of all channels are linked,
+     * each band passes through the shared computer and the attack/release of a PSFollower at the frame rate,
+     * then the band gains are spread to bins, smoothed across band edges (in dB) and applied before resynthesis
+     * the band loops work on separate arrays, so they vectorize across bands
+     * the STFT uses sqrt-Hann analysis/synthesis windows with 75% overlap, the latency is the FFT size
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class SpectralCompressor {
+    public:
+        static constexpr FloatType kMinBandFreq = FloatType(20);
+
+        explicit SpectralCompressor(KneeComputer<FloatType, true> &computer) : computer_(computer) {
+        }
+
+        /**
+         * call before processing starts
+         * @param sr sample rate
+         * @param num_channels
+         * @param order the FFT size is 2^order
+         * @param band_num the maximum number of bands, bands narrower than a bin are merged
+         */
+        void prepare(const double sr, const size_t num_channels, const size_t order, const size_t band_num) {
+            process_counter_.prepare("zldsp::compressor::SpectralCompressor::process", this);
+            fft_.setOrder(order);
+            fft_size_ = fft_.getSize();
+            hop_size_ = fft_size_ / 4;
+            bin_size_ = fft_size_ / 2 + 1;
+            follower_.prepare(sr / static_cast<double>(hop_size_));
+
+            window_.resize(fft_size_);
+            for (size_t i = 0; i < fft_size_; ++i) {
+                window_[i] = static_cast<FloatType>(std::sqrt(
+                    0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(fft_size_))));
+            }
+            // sqrt-Hann^2 sums to 2 at 75% overlap, the inverse FFT is not normalized
+            synthesis_scale_ = FloatType(1) / (FloatType(2) * static_cast<FloatType>(fft_size_));
+            // the band power is the mean square of the band-limited signal
+            power_scale_ = FloatType(4) / (static_cast<FloatType>(fft_size_) * static_cast<FloatType>(fft_size_) *
+                                           static_cast<FloatType>(num_channels));
+
+            in_buffers_.resize(num_channels);
+            out_buffers_.resize(num_channels);
+            spectrums_.resize(num_channels);
+            for (size_t chan = 0; chan < num_channels; ++chan) {
+                in_buffers_[chan].resize(fft_size_);
+                out_buffers_[chan].resize(fft_size_);
+                spectrums_[chan].resize(bin_size_);
+            }
+            frame_.resize(fft_size_ * 2);
+
+            setBands(sr, band_num);
+            bin_gain_dbs_.resize(bin_size_);
+            bin_gains_.resize(bin_size_);
+            reset();
+        }
+
+        void reset() {
+            for (auto &b: in_buffers_) {
+                std::fill(b.begin(), b.end(), FloatType(0));
+            }
+            for (auto &b: out_buffers_) {
+                std::fill(b.begin(), b.end(), FloatType(0));
+            }
+            std::fill(band_followers_.begin(), band_followers_.end(), FloatType(0));
+            hop_pos_ = 0;
+        }
+
+        /**
+         * update values before processing a buffer
+         */
+        void prepareBuffer() {
+            follower_.prepareBuffer();
+        }
+
+        void process(std::span<FloatType *> buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::SpectralCompressor::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            size_t start = 0;
+            while (start < num_samples) {
+                const auto num = std::min(num_samples - start, hop_size_ - hop_pos_);
+                const auto in_pos = fft_size_ - hop_size_ + hop_pos_;
+                for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                    auto *x = buffer[chan] + start;
+                    std::copy(x, x + num, in_buffers_[chan].begin() + static_cast<std::ptrdiff_t>(in_pos));
+                    std::copy(out_buffers_[chan].begin() + static_cast<std::ptrdiff_t>(hop_pos_),
+                              out_buffers_[chan].begin() + static_cast<std::ptrdiff_t>(hop_pos_ + num), x);
+                }
+                hop_pos_ += num;
+                start += num;
+                if (hop_pos_ == hop_size_) {
+                    processFrame(buffer.size());
+                    hop_pos_ = 0;
+                }
+            }
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @param millisecond
+         */
+        void setAttack(const FloatType millisecond) {
+            follower_.setAttack(millisecond);
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @param millisecond
+         */
+        void setRelease(const FloatType millisecond) {
+            follower_.setRelease(millisecond);
+        }
+
+        [[nodiscard]] size_t getLatency() const { return fft_size_; }
+
+        [[nodiscard]] size_t getBandNum() const { return band_followers_.size(); }
+
+        /**
+         * @param band
+         * @return the current gain reduction of the band in dB
+         */
+        FloatType getBandGainDB(const size_t band) const { return -band_followers_[band]; }
+
+    private:
+        KneeComputer<FloatType, true> &computer_;
+        // runs at the frame rate, its attack/release are applied to the states of all bands
+        PSFollower<FloatType> follower_;
+        fft::KFREngine<FloatType> fft_;
+        size_t fft_size_{0}, hop_size_{0}, bin_size_{0}, hop_pos_{0};
+        FloatType synthesis_scale_{0}, power_scale_{0};
+        kfr::univector<FloatType> window_, frame_;
+        std::vector<kfr::univector<FloatType> > in_buffers_, out_buffers_;
+        std::vector<std::vector<std::complex<FloatType> > > spectrums_;
+
+        // bands
+        std::vector<size_t> band_starts_;
+        // the linked powers, the levels / reductions in dB and the follower states of the bands
+        kfr::univector<FloatType> band_powers_, band_dbs_, band_followers_;
+        std::vector<size_t> bin_bands_;
+        kfr::univector<FloatType> bin_gain_dbs_, bin_gains_;
+
+        chore::CycleCounter process_counter_;
+
+        void setBands(const double sr, const size_t band_num) {
+            band_starts_.clear();
+            band_starts_.push_back(0);
+            const auto nyquist = sr * 0.5;
+            const auto ratio = std::log(nyquist / static_cast<double>(kMinBandFreq));
+            for (size_t b = 0; b < band_num; ++b) {
+                const auto freq = static_cast<double>(kMinBandFreq) *
+                                  std::exp(ratio * static_cast<double>(b) / static_cast<double>(band_num));
+                const auto bin = static_cast<size_t>(std::round(freq / sr * static_cast<double>(fft_size_)));
+                if (bin > band_starts_.back() && bin < bin_size_) {
+                    band_starts_.push_back(bin);
+                }
+            }
+            band_starts_.push_back(bin_size_);
+            const auto actual_band_num = band_starts_.size() - 1;
+            band_powers_.resize(actual_band_num);
+            band_dbs_.resize(actual_band_num);
+            band_followers_.resize(actual_band_num);
+
+            bin_bands_.resize(bin_size_);
+            for (size_t b = 0; b < actual_band_num; ++b) {
+                std::fill(bin_bands_.begin() + static_cast<std::ptrdiff_t>(band_starts_[b]),
+                          bin_bands_.begin() + static_cast<std::ptrdiff_t>(band_starts_[b + 1]), b);
+            }
+        }
+
+        void processFrame(const size_t num_channels) {
+            // analysis
+            for (size_t chan = 0; chan < num_channels; ++chan) {
+                auto frame = kfr::make_univector(frame_.data(), fft_size_);
+                frame = in_buffers_[chan] * window_;
+                fft_.forward(frame_.data(), spectrums_[chan].data());
+            }
+            // linked band powers
+            const auto band_num = band_powers_.size();
+            for (size_t b = 0; b < band_num; ++b) {
+                FloatType power{0};
+                for (size_t chan = 0; chan < num_channels; ++chan) {
+                    const auto &spectrum{spectrums_[chan]};
+                    for (size_t j = band_starts_[b]; j < band_starts_[b + 1]; ++j) {
+                        power += std::norm(spectrum[j]);
+                    }
+                }
+                band_powers_[b] = power;
+            }
+            // computer and follower across bands, each step is a branch-free loop over the band arrays
+            band_dbs_ = FloatType(10) * kfr::log10(kfr::max(band_powers_ * power_scale_, FloatType(1e-12)));
+            computer_.eval(std::span<const FloatType>(band_dbs_.data(), band_num),
+                           std::span<FloatType>(band_dbs_.data(), band_num));
+            band_dbs_ = -band_dbs_;
+            follower_.processStates(std::span<const FloatType>(band_dbs_.data(), band_num),
+                                    std::span<FloatType>(band_followers_.data(), band_num));
+            // spread band gains to bins, then smooth the steps at the band edges
+            for (size_t j = 0; j < bin_size_; ++j) {
+                bin_gains_[j] = -band_followers_[bin_bands_[j]];
+            }
+            bin_gain_dbs_[0] = bin_gains_[0];
+            bin_gain_dbs_[bin_size_ - 1] = bin_gains_[bin_size_ - 1];
+            for (size_t j = 1; j + 1 < bin_size_; ++j) {
+                bin_gain_dbs_[j] = FloatType(0.25) * (bin_gains_[j - 1] + bin_gains_[j + 1]) + FloatType(0.5) * bin_gains_[j];
+            }
+            bin_gains_ = kfr::exp10(bin_gain_dbs_ * FloatType(0.05)) * synthesis_scale_;
+            // resynthesis
+            for (size_t chan = 0; chan < num_channels; ++chan) {
+                auto &spectrum{spectrums_[chan]};
+                for (size_t j = 0; j < bin_size_; ++j) {
+                    spectrum[j] *= bin_gains_[j];
+                }
+                fft_.backward(spectrum.data(), frame_.data());
+                auto &out_buffer{out_buffers_[chan]};
+                std::copy(out_buffer.begin() + static_cast<std::ptrdiff_t>(hop_size_), out_buffer.end(), out_buffer.begin());
+                std::fill(out_buffer.end() - static_cast<std::ptrdiff_t>(hop_size_), out_buffer.end(), FloatType(0));
+                for (size_t i = 0; i < fft_size_; ++i) {
+                    out_buffer[i] += frame_[i] * window_[i];
+                }
+                auto &in_buffer{in_buffers_[chan]};
+                std::copy(in_buffer.begin() + static_cast<std::ptrdiff_t>(hop_size_), in_buffer.end(), in_buffer.begin());
+            }
+        }
+    };
+}
@@ -22,24 +22,66 @@ namespace zldsp::compressor {
                           RMSTracker<FloatType> &tracker,
                           FollowerBase<FloatType> &follower)
             : base(computer, tracker, follower) {
+            process_counter_.prepare("zldsp::compressor::ClassicCompressor::process", this);
         }
 
         void reset() override {
             base::follower_.reset(FloatType(0));
+            base::hilbert_.reset();
             x0_ = FloatType(0);
         }
 
-        template <bool UseRMS = false>
+        /**
+         * @tparam UseRMS use the RMS tracker as the detector
+         * @tparam UseHilbert use the Hilbert envelope instead of abs(x) as the peak detector
+         */
+        template <bool UseRMS = false, bool UseHilbert = false>
         void process(FloatType *buffer, const size_t num_samples) {
+            static_assert(!(UseRMS && UseHilbert), "the Hilbert envelope is a peak detector");
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::ClassicCompressor::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            processImpl<UseRMS, UseHilbert>(buffer, num_samples, [](const FloatType x) { return x; });
+        }
+
+        /**
+         * process with a sidechain filter fused into the detector loop, the filter sees the feedback samples
+         * @tparam SideFilter e.g. zldsp::filter::IIR prepared with a single channel
+         * @param buffer
+         * @param num_samples
+         * @param side_filter
+         */
+        template <bool UseRMS = false, bool UseHilbert = false, typename SideFilter>
+        void process(FloatType *buffer, const size_t num_samples, SideFilter &side_filter) {
+            static_assert(!(UseRMS && UseHilbert), "the Hilbert envelope is a peak detector");
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::ClassicCompressor::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            if (side_filter.isSmoothing()) {
+                processImpl<UseRMS, UseHilbert>(buffer, num_samples, [&side_filter](const FloatType x) {
+                    return side_filter.template processSample<true>(0, x);
+                });
+            } else {
+                processImpl<UseRMS, UseHilbert>(buffer, num_samples, [&side_filter](const FloatType x) {
+                    return side_filter.template processSample<false>(0, x);
+                });
+            }
+        }
+
+    private:
+        FloatType x0_{FloatType(0)};
+        chore::CycleCounter process_counter_;
+
+        template <bool UseRMS, bool UseHilbert, typename SideFunc>
+        void processImpl(FloatType *buffer, const size_t num_samples, SideFunc &&side_func) {
             for (size_t i = 0; i < num_samples; ++i) {
+                const auto x = side_func(x0_);
                 FloatType input_db;
                 if (UseRMS) {
                     // pass the feedback sample through the tracker
-                    base::tracker_.processSample(x0_);
+                    base::tracker_.processSample(x);
                     // get the db from the tracker
                     input_db = base::tracker_.getMomentaryDB();
                 } else {
-                    input_db = chore::gainToDecibels(std::abs(x0_));
+                    input_db = chore::gainToDecibels(UseHilbert ? base::hilbert_.processSample(x) : std::abs(x));
                 }
                 // pass through the computer and the follower
                 const auto smooth_reduction_db = -base::follower_.processSample(-base::computer_.eval(input_db));
@@ -48,8 +90,5 @@ namespace zldsp::compressor {
                 buffer[i] = smooth_reduction_db;
             }
         }
-
-    private:
-        FloatType x0_{FloatType(0)};
     };
 }
@@ -0,0 +1,184 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+
+#include "../../chore/decibels.hpp"
+#include "style_base.hpp"
+
+namespace zldsp::compressor {
+    /**
+     * a feed-forward compressor (like CleanCompressor) whose computer and follower run at a control rate
+     * the detector takes the peak or the mean square of each sub-block of decimation samples,
+     * the gain (in dB) then ramps linearly across the next sub-block, which delays it by one sub-block
+     * the follower and the tracker must be prepared at sample_rate / decimation, call prepare to do so
+     * optionally, a reference follower (and tracker) prepared at the full rate runs alongside,
+     * and the maximum difference between the ramped gain and the full-rate gain is reported
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class DecimatedCompressor final : public CompressorStyleBase<FloatType> {
+    public:
+        using base = CompressorStyleBase<FloatType>;
+
+        DecimatedCompressor(ComputerBase<FloatType> &computer,
+                            RMSTracker<FloatType> &tracker,
+                            FollowerBase<FloatType> &follower)
+            : base(computer, tracker, follower) {
+        }
+
+        /**
+         * call before processing starts, not real-time safe
+         * prepares the follower and the tracker at the control rate
+         * @param sr the audio sample rate
+         * @param decimation the number of audio samples per control sample
+         */
+        void prepare(const double sr, const size_t decimation) {
+            decimation_ = std::max(decimation, static_cast<size_t>(1));
+            decimation_r_ = FloatType(1) / static_cast<FloatType>(decimation_);
+            const auto control_sr = sr / static_cast<double>(decimation_);
+            base::follower_.prepare(control_sr);
+            base::tracker_.prepare(control_sr);
+            process_counter_.prepare("zldsp::compressor::DecimatedCompressor::process", this);
+            reset();
+        }
+
+        void reset() override {
+            base::follower_.reset(FloatType(0));
+            base::hilbert_.reset();
+            if (ref_follower_ != nullptr) {
+                ref_follower_->reset(FloatType(0));
+            }
+            ref_hilbert_.reset();
+            detector_ = FloatType(0);
+            detector_pos_ = 0;
+            ramp_value_ = FloatType(0);
+            ramp_step_ = FloatType(0);
+        }
+
+        /**
+         * set the reference path for error reporting, call before processing starts
+         * @param follower a follower with the same parameters, prepared at the full rate, nullptr to disable
+         * @param tracker a tracker with the same parameters, prepared at the full rate, required for RMS
+         * @param max_num_samples the maximum number of samples per process call
+         */
+        void setReference(FollowerBase<FloatType> *follower, RMSTracker<FloatType> *tracker,
+                          const size_t max_num_samples) {
+            ref_buffer_.resize(max_num_samples);
+            ref_follower_ = follower;
+            ref_tracker_ = tracker;
+            resetError();
+        }
+
+        /**
+         * @return the maximum absolute difference (in dB) between the ramped gain and the full-rate gain
+         */
+        FloatType getMaxError() const { return max_error_.load(std::memory_order::relaxed); }
+
+        void resetError() { max_error_.store(FloatType(0), std::memory_order::relaxed); }
+
+        [[nodiscard]] size_t getDecimation() const { return decimation_; }
+
+        /**
+         * @tparam UseRMS use the RMS tracker as the detector
+         * @tparam UseHilbert use the Hilbert envelope instead of abs(x) as the peak detector
+         */
+        template <bool UseRMS = false, bool UseHilbert = false>
+        void process(FloatType *buffer, const size_t num_samples) {
+            static_assert(!(UseRMS && UseHilbert), "the Hilbert envelope is a peak detector");
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::DecimatedCompressor::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            if (ref_follower_ != nullptr && (!UseRMS || ref_tracker_ != nullptr)) {
+                processReference<UseRMS, UseHilbert>(buffer, num_samples);
+            }
+            size_t start = 0;
+            while (start < num_samples) {
+                const auto num = std::min(num_samples - start, decimation_ - detector_pos_);
+                auto vector = kfr::make_univector(buffer + start, num);
+                if (UseRMS) {
+                    detector_ += kfr::sumsqr(vector);
+                } else if (UseHilbert) {
+                    base::hilbert_.process(buffer + start, num);
+                    detector_ = std::max(detector_, kfr::maxof(vector));
+                } else {
+                    detector_ = std::max(detector_, kfr::absmaxof(vector));
+                }
+                // ramp the gain of the last control sample
+                const auto ramp_start = ramp_value_;
+                for (size_t i = 0; i < num; ++i) {
+                    vector[i] = ramp_start + ramp_step_ * static_cast<FloatType>(i + 1);
+                }
+                ramp_value_ = ramp_start + ramp_step_ * static_cast<FloatType>(num);
+                detector_pos_ += num;
+                start += num;
+                if (detector_pos_ == decimation_) {
+                    processControlSample<UseRMS>();
+                    detector_pos_ = 0;
+                    detector_ = FloatType(0);
+                }
+            }
+            if (ref_follower_ != nullptr && (!UseRMS || ref_tracker_ != nullptr)) {
+                FloatType error{0};
+                for (size_t i = 0; i < num_samples; ++i) {
+                    error = std::max(error, std::abs(buffer[i] - ref_buffer_[i]));
+                }
+                if (error > max_error_.load(std::memory_order::relaxed)) {
+                    max_error_.store(error, std::memory_order::relaxed);
+                }
+            }
+        }
+
+    private:
+        size_t decimation_{1};
+        FloatType decimation_r_{FloatType(1)};
+        FloatType detector_{FloatType(0)};
+        size_t detector_pos_{0};
+        FloatType ramp_value_{FloatType(0)}, ramp_step_{FloatType(0)};
+
+        FollowerBase<FloatType> *ref_follower_{nullptr};
+        RMSTracker<FloatType> *ref_tracker_{nullptr};
+        HilbertEnvelope<FloatType> ref_hilbert_;
+        kfr::univector<FloatType> ref_buffer_;
+        std::atomic<FloatType> max_error_{FloatType(0)};
+        chore::CycleCounter process_counter_;
+
+        template <bool UseRMS>
+        void processControlSample() {
+            FloatType input_db;
+            if (UseRMS) {
+                // feed the RMS of the sub-block, the tracker squares it again
+                base::tracker_.processSample(std::sqrt(detector_ * decimation_r_));
+                input_db = base::tracker_.getMomentaryDB();
+            } else {
+                input_db = chore::gainToDecibels(detector_);
+            }
+            const auto target = -base::follower_.processSample(-base::computer_.eval(input_db));
+            ramp_step_ = (target - ramp_value_) * decimation_r_;
+        }
+
+        template <bool UseRMS, bool UseHilbert>
+        void processReference(const FloatType *buffer, const size_t num_samples) {
+            for (size_t i = 0; i < num_samples; ++i) {
+                FloatType input_db;
+                if (UseRMS) {
+                    ref_tracker_->processSample(buffer[i]);
+                    input_db = ref_tracker_->getMomentaryDB();
+                } else {
+                    input_db = chore::gainToDecibels(UseHilbert
+                                                         ? ref_hilbert_.processSample(buffer[i])
+                                                         : std::abs(buffer[i]));
+                }
+                ref_buffer_[i] = -ref_follower_->processSample(-base::computer_.eval(input_db));
+            }
+        }
+    };
+}
@@ -21,25 +21,74 @@ namespace zldsp::compressor {
                           RMSTracker<FloatType> &tracker,
                           FollowerBase<FloatType> &follower)
             : base(computer, tracker, follower) {
+            process_counter_.prepare("zldsp::compressor::OpticalCompressor::process", this);
         }
 
         void reset() override {
             base::follower_.reset(FloatType(0));
+            base::hilbert_.reset();
         }
 
-        template <bool UseRMS = false>
+        /**
+         * @tparam UseRMS use the RMS tracker as the detector
+         * @tparam UseHilbert use the Hilbert envelope instead of abs(x) as the peak detector
+         */
+        template <bool UseRMS = false, bool UseHilbert = false>
         void process(FloatType *buffer, const size_t num_samples) {
+            static_assert(!(UseRMS && UseHilbert), "the Hilbert envelope is a peak detector");
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::OpticalCompressor::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            processImpl<UseRMS, UseHilbert, false>(buffer, num_samples, [](const FloatType x) { return x; });
+        }
+
+        /**
+         * process with a sidechain filter fused into the detector loop
+         * @tparam SideFilter e.g. zldsp::filter::IIR prepared with a single channel
+         * @param buffer
+         * @param num_samples
+         * @param side_filter
+         */
+        template <bool UseRMS = false, bool UseHilbert = false, typename SideFilter>
+        void process(FloatType *buffer, const size_t num_samples, SideFilter &side_filter) {
+            static_assert(!(UseRMS && UseHilbert), "the Hilbert envelope is a peak detector");
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::OpticalCompressor::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            if (side_filter.isSmoothing()) {
+                processImpl<UseRMS, UseHilbert, true>(buffer, num_samples, [&side_filter](const FloatType x) {
+                    return side_filter.template processSample<true>(0, x);
+                });
+            } else {
+                processImpl<UseRMS, UseHilbert, true>(buffer, num_samples, [&side_filter](const FloatType x) {
+                    return side_filter.template processSample<false>(0, x);
+                });
+            }
+        }
+
+    private:
+        chore::CycleCounter process_counter_;
+
+        template <bool UseRMS, bool UseHilbert, bool UseFilter, typename SideFunc>
+        void processImpl(FloatType *buffer, const size_t num_samples, SideFunc &&side_func) {
             auto vector = kfr::make_univector(buffer, num_samples);
             if (UseRMS) {
                 // pass through the tracker
                 for (size_t i = 0; i < num_samples; ++i) {
-                    base::tracker_.processSample(vector[i]);
+                    base::tracker_.processSample(side_func(vector[i]));
                     vector[i] = base::tracker_.getMomentarySquare();
                 }
                 const auto mean_scale = FloatType(1) / static_cast<FloatType>(base::tracker_.getCurrentBufferSize());
                 vector = kfr::sqrt(vector * mean_scale);
             } else {
-                vector = kfr::abs(vector);
+                if (UseFilter) {
+                    for (size_t i = 0; i < num_samples; ++i) {
+                        vector[i] = side_func(vector[i]);
+                    }
+                }
+                if (UseHilbert) {
+                    base::hilbert_.process(buffer, num_samples);
+                } else {
+                    vector = kfr::abs(vector);
+                }
             }
             // pass through the follower
             for (size_t i = 0; i < num_samples; ++i) {
@@ -9,11 +9,16 @@
 
 #pragma once
 
+#include <array>
+#include <algorithm>
+
 #include "../computer/computer.hpp"
 #include "../tracker/tracker.hpp"
 #include "../follower/follower.hpp"
 
 #include "../../vector/vector.hpp"
+#include "../../chore/realtime_check.hpp"
+#include "../../chore/cycle_counter.hpp"
 
 namespace zldsp::compressor {
     template<typename FloatType>
@@ -33,5 +38,36 @@ namespace zldsp::compressor {
         ComputerBase<FloatType> &computer_;
         RMSTracker<FloatType> &tracker_;
         FollowerBase<FloatType> &follower_;
+        // the detector of UseHilbert, replaces abs(x) of the peak detector
+        HilbertEnvelope<FloatType> hilbert_;
     };
+
+    /**
+     * run a style on every stride-th sample of buffer, e.g. one channel of an interleaved buffer
+     * the samples are gathered into blocks on the stack, so the style keeps its contiguous (vectorized) loops
+     * @tparam UseRMS
+     * @tparam UseHilbert
+     * @param style a style, e.g. CleanCompressor
+     * @param buffer
+     * @param stride the distance between two samples, i.e. the number of interleaved channels
+     * @param num_samples
+     */
+    template<bool UseRMS = false, bool UseHilbert = false, typename Style, typename FloatType>
+    void processStrided(Style &style, FloatType *buffer, const size_t stride, const size_t num_samples) {
+        constexpr size_t kBlockSize = 256;
+        std::array<FloatType, kBlockSize> block{};
+        size_t start = 0;
+        while (start < num_samples) {
+            const auto num = std::min(num_samples - start, kBlockSize);
+            auto *strided = buffer + start * stride;
+            for (size_t i = 0; i < num; ++i) {
+                block[i] = strided[i * stride];
+            }
+            style.template process<UseRMS, UseHilbert>(block.data(), num);
+            for (size_t i = 0; i < num; ++i) {
+                strided[i * stride] = block[i];
+            }
+            start += num;
+        }
+    }
 }
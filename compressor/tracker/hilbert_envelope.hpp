@@ -0,0 +1,132 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+#include "../../vector/kfr_import.hpp"
+
+namespace zldsp::compressor {
+    /**
+     * an envelope detector which takes the magnitude of the analytic signal
+     * the analytic signal comes from a pair of allpass chains whose phase responses differ by 90 degrees
+     * (Olli Niemitalo's coefficients, within 0.7 degree from 20 Hz to 22 kHz at 44.1 kHz, the band scales with the
+     * sample rate), so the envelope of a sine does not ripple like abs(x)
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class HilbertEnvelope {
+    public:
+        static constexpr size_t kSectionNum = 4;
+        static constexpr size_t kBlockSize = 64;
+
+        HilbertEnvelope() = default;
+
+        void reset() {
+            for (auto &s: states_) {
+                s = {};
+            }
+            delay_ = FloatType(0);
+        }
+
+        /**
+         * replace the samples with the envelope, in blocks of kBlockSize
+         * @param buffer
+         * @param num_samples
+         */
+        void process(FloatType *buffer, const size_t num_samples) {
+            size_t start = 0;
+            while (start < num_samples) {
+                const auto num = std::min(num_samples - start, kBlockSize);
+                auto *x = buffer + start;
+                // the in-phase chain, delayed by one sample
+                in_phase_[0] = delay_;
+                std::copy(x, x + num - 1, in_phase_.begin() + 1);
+                delay_ = x[num - 1];
+                std::copy(x, x + num, quadrature_.begin());
+                for (size_t k = 0; k < kSectionNum; ++k) {
+                    processSection(in_phase_.data(), num, kCoeffs[0][k], states_[k]);
+                }
+                for (size_t k = 0; k < kSectionNum; ++k) {
+                    processSection(quadrature_.data(), num, kCoeffs[1][k], states_[kSectionNum + k]);
+                }
+                auto in_phase = kfr::make_univector(in_phase_.data(), num);
+                auto quadrature = kfr::make_univector(quadrature_.data(), num);
+                auto vector = kfr::make_univector(x, num);
+                vector = kfr::sqrt(in_phase * in_phase + quadrature * quadrature);
+                start += num;
+            }
+        }
+
+        /**
+         * @param x
+         * @return the envelope
+         */
+        FloatType processSample(const FloatType x) {
+            auto in_phase = delay_;
+            delay_ = x;
+            auto quadrature = x;
+            for (size_t k = 0; k < kSectionNum; ++k) {
+                in_phase = processSectionSample(in_phase, kCoeffs[0][k], states_[k]);
+            }
+            for (size_t k = 0; k < kSectionNum; ++k) {
+                quadrature = processSectionSample(quadrature, kCoeffs[1][k], states_[kSectionNum + k]);
+            }
+            return std::sqrt(in_phase * in_phase + quadrature * quadrature);
+        }
+
+    private:
+        // squared coefficients of y[n] = a^2 * (x[n] + y[n-2]) - x[n-2]
+        static constexpr std::array<std::array<FloatType, kSectionNum>, 2> kCoeffs{
+            {
+                {
+                    FloatType(0.6923878 * 0.6923878), FloatType(0.9360654322959 * 0.9360654322959),
+                    FloatType(0.9882295226860 * 0.9882295226860), FloatType(0.9987488452737 * 0.9987488452737)
+                },
+                {
+                    FloatType(0.4021921162426 * 0.4021921162426), FloatType(0.8561710882420 * 0.8561710882420),
+                    FloatType(0.9722909545651 * 0.9722909545651), FloatType(0.9952884791278 * 0.9952884791278)
+                }
+            }
+        };
+
+        // x[n-1], x[n-2], y[n-1], y[n-2] of each section
+        std::array<std::array<FloatType, 4>, kSectionNum * 2> states_{};
+        FloatType delay_{FloatType(0)};
+        std::array<FloatType, kBlockSize> in_phase_{}, quadrature_{};
+
+        static FloatType processSectionSample(const FloatType x, const FloatType c, std::array<FloatType, 4> &s) {
+            const auto y = c * (x + s[3]) - s[1];
+            s[1] = s[0];
+            s[0] = x;
+            s[3] = s[2];
+            s[2] = y;
+            return y;
+        }
+
+        static void processSection(FloatType *data, const size_t num_samples, const FloatType c,
+                                   std::array<FloatType, 4> &s) {
+            // keep the states in registers for the whole block
+            auto x1 = s[0], x2 = s[1], y1 = s[2], y2 = s[3];
+            for (size_t i = 0; i < num_samples; ++i) {
+                const auto x = data[i];
+                const auto y = c * (x + y2) - x2;
+                x2 = x1;
+                x1 = x;
+                y2 = y1;
+                y1 = y;
+                data[i] = y;
+            }
+            s = {x1, x2, y1, y2};
+        }
+    };
+}
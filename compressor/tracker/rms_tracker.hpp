@@ -9,15 +9,28 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <algorithm>
 
 #include "../../container/container.hpp"
+#include "../../chore/realtime_check.hpp"
 
 namespace zldsp::compressor {
+    enum RMSMode {
+        // a moving average over the momentary window, the memory grows with the maximum window
+        kBoxcar,
+        // a one-pole on x^2 with the same equivalent noise bandwidth as the window, O(1) memory
+        kExponential,
+        // three one-poles whose impulse response matches the mean and the variance of the window, O(1) memory
+        kCascade
+    };
+
     /**
      * a tracker that tracks the momentary RMS loudness of the audio signal
+     * if only the exponential or cascade modes are used, set the maximum momentary seconds to 0 to save memory
+     * the boxcar window is clamped to the maximum momentary seconds
      * @tparam FloatType
      */
     template<typename FloatType>
@@ -39,6 +52,7 @@ namespace zldsp::compressor {
         void reset() {
             square_sum_ = FloatType(0);
             square_buffer_.clear();
+            std::fill(mean_squares_.begin(), mean_squares_.end(), FloatType(0));
         }
 
         /**
@@ -56,24 +70,77 @@ namespace zldsp::compressor {
          * update values before processing a buffer
          */
         void prepareBuffer() {
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::RMSTracker::prepareBuffer");
             if (to_update_.exchange(false, std::memory_order::acquire)) {
+                const auto mean_square = getMeanSquare();
+                const auto new_mode = mode_.load(std::memory_order::relaxed);
+                if (new_mode != c_mode_) {
+                    if (new_mode == kBoxcar) {
+                        // the boxcar has not been fed, restart it
+                        square_sum_ = FloatType(0);
+                        square_buffer_.clear();
+                    } else {
+                        // continue from the current mean square
+                        std::fill(mean_squares_.begin(), mean_squares_.end(), mean_square);
+                    }
+                    c_mode_ = new_mode;
+                }
                 c_buffer_size_ = buffer_size_.load(std::memory_order::relaxed);
+                if (c_mode_ == kBoxcar) {
+                    // the boxcar cannot be longer than the buffer allocated by the maximum momentary seconds
+                    c_buffer_size_ = std::min(c_buffer_size_, square_buffer_.capacity());
+                }
                 c_buffer_size_r = FloatType(1) / static_cast<FloatType>(c_buffer_size_);
-                while (square_buffer_.size() > c_buffer_size_) {
-                    square_sum_ -= square_buffer_.popFront();
+                if (c_mode_ == kBoxcar) {
+                    while (square_buffer_.size() > c_buffer_size_) {
+                        square_sum_ -= square_buffer_.popFront();
+                    }
                 }
+                // time constants of window / 2 (same noise bandwidth) and window / 6 per stage (same mean and variance)
+                const auto size = static_cast<double>(c_buffer_size_);
+                pole_ = static_cast<FloatType>(std::exp(
+                    (c_mode_ == kCascade ? -2.0 * static_cast<double>(kCascadeNum) : -2.0) / size));
             }
         }
 
         void processSample(const FloatType x) {
+            ZLDSP_REALTIME_SCOPE("zldsp::compressor::RMSTracker::processSample");
             const FloatType square = x * x;
-            if (square_buffer_.size() == c_buffer_size_) {
-                square_sum_ -= square_buffer_.popFront();
+            switch (c_mode_) {
+                case kBoxcar: {
+                    if (square_buffer_.size() == c_buffer_size_) {
+                        square_sum_ -= square_buffer_.popFront();
+                    }
+                    square_buffer_.pushBack(square);
+                    square_sum_ += square;
+                    break;
+                }
+                case kExponential: {
+                    mean_squares_[kCascadeNum - 1] = pole_ * (mean_squares_[kCascadeNum - 1] - square) + square;
+                    break;
+                }
+                case kCascade: {
+                    auto y = square;
+                    for (size_t k = 0; k < kCascadeNum; ++k) {
+                        mean_squares_[k] = pole_ * (mean_squares_[k] - y) + y;
+                        y = mean_squares_[k];
+                    }
+                    break;
+                }
             }
-            square_buffer_.pushBack(square);
-            square_sum_ += square;
         }
 
+        /**
+         * thread-safe, lock-free
+         * @param x
+         */
+        void setMode(const RMSMode x) {
+            mode_.store(x, std::memory_order::relaxed);
+            to_update_.store(true, std::memory_order::release);
+        }
+
+        RMSMode getMode() const { return mode_.load(std::memory_order::relaxed); }
+
         /**
          * thread-safe, lock-free
          * set the time length of the tracker
@@ -95,18 +162,30 @@ namespace zldsp::compressor {
 
         size_t getCurrentBufferSize() const { return c_buffer_size_; }
 
+        /**
+         * @return the sum of squares over the window, in the exponential or cascade modes
+         * the mean square times the window size, so that dividing by getCurrentBufferSize gives the mean square
+         */
         FloatType getMomentarySquare() {
-            return square_sum_;
+            return c_mode_ == kBoxcar
+                       ? square_sum_
+                       : mean_squares_[kCascadeNum - 1] * static_cast<FloatType>(c_buffer_size_);
         }
 
         FloatType getMomentaryDB() {
-            FloatType mean_square = square_sum_ * c_buffer_size_r;
-            return std::log10(std::max(FloatType(1e-10), mean_square)) * FloatType(10);
+            return std::log10(std::max(FloatType(1e-10), getMeanSquare())) * FloatType(10);
         }
 
     private:
+        static constexpr size_t kCascadeNum = 3;
+
         FloatType square_sum_{0};
         container::CircularBuffer<FloatType> square_buffer_{1};
+        // the exponential mode uses the last one only
+        std::array<FloatType, kCascadeNum> mean_squares_{};
+        FloatType pole_{0};
+        std::atomic<RMSMode> mode_{kBoxcar};
+        RMSMode c_mode_{kBoxcar};
 
         std::atomic<double> sample_rate_{48000.0};
         std::atomic<FloatType> time_length_{0};
@@ -116,6 +195,10 @@ namespace zldsp::compressor {
         std::atomic<size_t> buffer_size_{1};
         std::atomic<bool> to_update_{true};
 
+        FloatType getMeanSquare() const {
+            return c_mode_ == kBoxcar ? square_sum_ * c_buffer_size_r : mean_squares_[kCascadeNum - 1];
+        }
+
         void setMomentarySize(size_t size) {
             size = std::max(static_cast<size_t>(1), size);
             buffer_size_.store(size, std::memory_order::relaxed);
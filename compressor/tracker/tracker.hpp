@@ -10,3 +10,4 @@
 #pragma once
 
 #include "rms_tracker.hpp"
+#include "hilbert_envelope.hpp"
@@ -11,8 +11,23 @@
 
 #include <atomic>
 #include <algorithm>
+#include <cstdint>
 
 namespace zldsp::container {
+    /**
+     * what the producer does when a block does not fit into the FIFO
+     */
+    enum class OverflowPolicy {
+        // write the oldest elements of the block that fit, drop the rest
+        kDropNewest,
+        // write the newest elements of the block that fit, and ask the consumer to discard the oldest elements
+        // of its backlog so that the next block fits entirely
+        kOverwriteOldest,
+        // write every step-th element of the block so that it fits
+        // the kept elements are time-compressed and aliased, e.g. an FFT analyzer sees a higher frequency content
+        kDecimate
+    };
+
     /**
      * an abstract FIFO that can be used by one producer and one consumer
      */
@@ -25,6 +40,15 @@ namespace zldsp::container {
             int block_size2;
         };
 
+        /**
+         * the producer should write element offset + k * step of the block for k < num_to_write
+         */
+        struct WritePlan {
+            int num_to_write;
+            int offset;
+            int step;
+        };
+
         explicit AbstractFIFO(const int capacity = 0)
             : capacity_(capacity),
               head_(0),
@@ -37,6 +61,7 @@ namespace zldsp::container {
             capacity_ = capacity;
             head_.store(0);
             tail_.store(0);
+            resync_pos_.store(-1);
         }
 
         int getCapacity() const { return capacity_; }
@@ -89,6 +114,7 @@ namespace zldsp::container {
                 const int current_tail = tail_.load(std::memory_order::relaxed);
                 const int new_tail = (current_tail + num_written) % capacity_;
                 tail_.store(new_tail, std::memory_order::release);
+                updateHighWater();
             }
         }
 
@@ -117,9 +143,109 @@ namespace zldsp::container {
             }
         }
 
+        /**
+         * thread-safe, lock-free
+         * @param x
+         */
+        void setOverflowPolicy(const OverflowPolicy x) { policy_.store(x, std::memory_order::relaxed); }
+
+        OverflowPolicy getOverflowPolicy() const { return policy_.load(std::memory_order::relaxed); }
+
+        /**
+         * plan to write a block of num_to_write elements under the overflow policy, only the producer may call this
+         * the elements which do not fit are counted as dropped
+         * call prepareToWrite / finishWrite with plan.num_to_write afterwards
+         * @param num_to_write
+         * @return
+         */
+        WritePlan planWrite(const int num_to_write) {
+            const int current_head = head_.load(std::memory_order::acquire);
+            const int current_tail = tail_.load(std::memory_order::relaxed);
+            const int num_ready = current_tail >= current_head
+                                      ? current_tail - current_head
+                                      : capacity_ - current_head + current_tail;
+            const int num_free = capacity_ - 1 - num_ready;
+            if (num_to_write <= num_free) {
+                return {num_to_write, 0, 1};
+            }
+            WritePlan plan{num_free, 0, 1};
+            switch (policy_.load(std::memory_order::relaxed)) {
+                case OverflowPolicy::kOverwriteOldest: {
+                    // the producer may not touch the unread elements, so it keeps the newest elements that fit now
+                    // and asks the consumer to discard the oldest num_to_write elements of the backlog,
+                    // even if the FIFO is full the newer part of the backlog survives and the next block fits
+                    plan.offset = num_to_write - num_free;
+                    const int num_discard = std::min(num_to_write, num_ready);
+                    resync_pos_.store((current_head + num_discard) % capacity_, std::memory_order::release);
+                    break;
+                }
+                case OverflowPolicy::kDecimate: {
+                    if (num_free > 0) {
+                        plan.step = (num_to_write + num_free - 1) / num_free;
+                        plan.num_to_write = (num_to_write + plan.step - 1) / plan.step;
+                    }
+                    break;
+                }
+                case OverflowPolicy::kDropNewest:
+                default: {
+                }
+            }
+            dropped_count_.fetch_add(static_cast<std::uint64_t>(num_to_write - plan.num_to_write),
+                                     std::memory_order::relaxed);
+            return plan;
+        }
+
+        /**
+         * discard the oldest elements as requested by the producer (kOverwriteOldest), only the consumer may call this
+         * call it before getNumReady
+         * @return the number of elements discarded
+         */
+        int applyResync() {
+            const int resync_pos = resync_pos_.exchange(-1, std::memory_order::acquire);
+            if (resync_pos < 0) return 0;
+            const int current_head = head_.load(std::memory_order::relaxed);
+            const int num_discard = resync_pos >= current_head
+                                        ? resync_pos - current_head
+                                        : capacity_ - current_head + resync_pos;
+            // the consumer may have read past the position already
+            if (num_discard == 0 || num_discard > getNumReady()) return 0;
+            head_.store(resync_pos, std::memory_order::release);
+            dropped_count_.fetch_add(static_cast<std::uint64_t>(num_discard), std::memory_order::relaxed);
+            return num_discard;
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @return the number of elements dropped by the producer or discarded by the consumer
+         */
+        std::uint64_t getDroppedCount() const { return dropped_count_.load(std::memory_order::relaxed); }
+
+        /**
+         * thread-safe, lock-free
+         * @return the maximum number of ready elements after a write
+         */
+        int getHighWater() const { return high_water_.load(std::memory_order::relaxed); }
+
+        void resetStats() {
+            dropped_count_.store(0, std::memory_order::relaxed);
+            high_water_.store(0, std::memory_order::relaxed);
+        }
+
     private:
         int capacity_;
         std::atomic<int> head_;
         std::atomic<int> tail_;
+        std::atomic<OverflowPolicy> policy_{OverflowPolicy::kDropNewest};
+        std::atomic<int> resync_pos_{-1};
+        std::atomic<std::uint64_t> dropped_count_{0};
+        std::atomic<int> high_water_{0};
+
+        void updateHighWater() {
+            const int num_ready = getNumReady();
+            int high_water = high_water_.load(std::memory_order::relaxed);
+            while (num_ready > high_water &&
+                   !high_water_.compare_exchange_weak(high_water, num_ready, std::memory_order::relaxed)) {
+            }
+        }
     };
 }
@@ -53,6 +53,10 @@ namespace zldsp::container {
             return N;
         }
 
+        auto begin() const { return data_.begin(); }
+
+        auto end() const { return data_.begin() + static_cast<std::ptrdiff_t>(size_); }
+
     private:
         std::array<T, N> data_{};
         size_t size_ = 0;
@@ -0,0 +1,293 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace zldsp::container {
+    /**
+     * a multichannel ring with one producer and any number of readers
+     * the producer writes each block once and never waits for the readers, the cost does not depend on
+     * the number of readers, each reader keeps its own cursor and copies the samples out
+     * a reader which falls more than capacity samples behind has been overrun, it skips to the newest
+     * sample and counts the overrun, a copy is validated against the write position afterwards
+     * (like a seqlock), so the samples which are overwritten during the copy are never returned
+     * the samples are accessed through relaxed atomic_ref loads / stores, so that the racing copy is well-defined
+     * @tparam T the type of elements
+     */
+    template<typename T>
+    class BroadcastRing {
+        static_assert(std::atomic_ref<T>::is_always_lock_free);
+
+    public:
+        /**
+         * a reader of the ring, which should only be used by one thread
+         */
+        class Reader {
+        public:
+            explicit Reader(const BroadcastRing &ring) : ring_(ring) {
+                resync();
+            }
+
+            /**
+             * skip to the newest sample
+             */
+            void resync() {
+                cursor_ = ring_.end_.load(std::memory_order::acquire);
+            }
+
+            /**
+             * @return the position of the next sample to read, i.e. the number of samples written before it
+             */
+            [[nodiscard]] std::uint64_t getPosition() const { return cursor_; }
+
+            [[nodiscard]] size_t getNumChannels() const { return ring_.data_.size(); }
+
+            /**
+             * @return the number of samples per channel that can be read
+             */
+            [[nodiscard]] size_t getNumReady() const {
+                const auto end = ring_.end_.load(std::memory_order::acquire);
+                if (end < cursor_) return 0;
+                return static_cast<size_t>(std::min(end - cursor_, static_cast<std::uint64_t>(ring_.capacity_)));
+            }
+
+            /**
+             * copy the ready samples into buffer
+             * @param buffer the destination, the channels beyond the channels of the ring are left untouched
+             * @param max_num_samples the maximum number of samples per channel to read
+             * @return the number of samples per channel read, 0 if the reader has been overrun
+             */
+            size_t read(std::span<T *> buffer, const size_t max_num_samples) {
+                const auto end = ring_.end_.load(std::memory_order::acquire);
+                if (end < cursor_) {
+                    // the ring has been prepared again
+                    cursor_ = end;
+                    return 0;
+                }
+                const auto capacity = static_cast<std::uint64_t>(ring_.capacity_);
+                if (end - cursor_ > capacity) {
+                    reportOverrun(end);
+                    return 0;
+                }
+                const auto num = static_cast<size_t>(std::min(end - cursor_,
+                                                              static_cast<std::uint64_t>(max_num_samples)));
+                if (num == 0) return 0;
+                const auto start = static_cast<size_t>(cursor_ & ring_.mask_);
+                const auto size1 = std::min(num, ring_.capacity_ - start);
+                const auto num_channels = std::min(buffer.size(), ring_.data_.size());
+                for (size_t chan = 0; chan < num_channels; ++chan) {
+                    auto *data = ring_.data_[chan].data();
+                    loadSamples(data + start, size1, buffer[chan]);
+                    loadSamples(data, num - size1, buffer[chan] + size1);
+                }
+                // the copy must not be reordered after the validation
+                std::atomic_thread_fence(std::memory_order::acquire);
+                const auto begin = ring_.begin_.load(std::memory_order::relaxed);
+                if (begin - cursor_ > capacity) {
+                    reportOverrun(ring_.end_.load(std::memory_order::acquire));
+                    return 0;
+                }
+                cursor_ += static_cast<std::uint64_t>(num);
+                return num;
+            }
+
+            /**
+             * thread-safe, lock-free
+             * @return the number of overruns of this reader
+             */
+            [[nodiscard]] std::uint64_t getOverrunCount() const {
+                return overrun_count_.load(std::memory_order::relaxed);
+            }
+
+            /**
+             * thread-safe, lock-free
+             * @return the number of samples per channel this reader has skipped due to overruns
+             */
+            [[nodiscard]] std::uint64_t getDroppedCount() const {
+                return dropped_count_.load(std::memory_order::relaxed);
+            }
+
+        private:
+            const BroadcastRing &ring_;
+            std::uint64_t cursor_{0};
+            std::atomic<std::uint64_t> overrun_count_{0}, dropped_count_{0};
+
+            void reportOverrun(const std::uint64_t end) {
+                overrun_count_.fetch_add(1, std::memory_order::relaxed);
+                dropped_count_.fetch_add(end - cursor_, std::memory_order::relaxed);
+                cursor_ = end;
+            }
+
+            static void loadSamples(T *source, const size_t num_samples, T *destination) {
+                for (size_t i = 0; i < num_samples; ++i) {
+                    destination[i] = std::atomic_ref<T>(source[i]).load(std::memory_order::relaxed);
+                }
+            }
+        };
+
+        BroadcastRing() = default;
+
+        /**
+         * call before processing starts, not real-time safe
+         * the readers should resync afterwards (they also do so on the next read)
+         * @param num_channels
+         * @param capacity the minimum number of samples per channel, rounded up to a power of two
+         */
+        void prepare(const size_t num_channels, const size_t capacity) {
+            capacity_ = 1;
+            while (capacity_ < capacity) {
+                capacity_ <<= 1;
+            }
+            mask_ = static_cast<std::uint64_t>(capacity_ - 1);
+            data_.resize(num_channels);
+            for (auto &data: data_) {
+                data.resize(capacity_);
+                std::fill(data.begin(), data.end(), T(0));
+            }
+            begin_.store(0, std::memory_order::relaxed);
+            end_.store(0, std::memory_order::release);
+        }
+
+        [[nodiscard]] size_t getCapacity() const { return capacity_; }
+
+        [[nodiscard]] size_t getNumChannels() const { return data_.size(); }
+
+        /**
+         * write a block, only the producer may call this
+         * if the block is longer than the capacity, only the newest capacity samples are kept
+         * @param buffer the source, the channels beyond the channels of the ring are ignored
+         * @param num_samples
+         */
+        void write(std::span<T *> buffer, size_t num_samples) {
+            auto end = end_.load(std::memory_order::relaxed);
+            size_t offset = 0;
+            if (num_samples > capacity_) {
+                offset = num_samples - capacity_;
+                end += static_cast<std::uint64_t>(offset);
+                num_samples = capacity_;
+            }
+            const auto new_end = end + static_cast<std::uint64_t>(num_samples);
+            // announce the samples to be overwritten before writing them
+            begin_.store(new_end, std::memory_order::relaxed);
+            std::atomic_thread_fence(std::memory_order::release);
+            const auto start = static_cast<size_t>(end & mask_);
+            const auto size1 = std::min(num_samples, capacity_ - start);
+            const auto num_channels = std::min(buffer.size(), data_.size());
+            for (size_t chan = 0; chan < num_channels; ++chan) {
+                auto *data = data_[chan].data();
+                const auto *source = buffer[chan] + offset;
+                storeSamples(source, size1, data + start);
+                storeSamples(source + size1, num_samples - size1, data);
+            }
+            end_.store(new_end, std::memory_order::release);
+        }
+
+    private:
+        // mutable as the readers load through atomic_ref, which does not accept const objects
+        mutable std::vector<std::vector<T> > data_;
+        size_t capacity_{1};
+        std::uint64_t mask_{0};
+        // the position after the newest sample which is being written / has been written
+        std::atomic<std::uint64_t> begin_{0}, end_{0};
+
+        static void storeSamples(const T *source, const size_t num_samples, T *destination) {
+            for (size_t i = 0; i < num_samples; ++i) {
+                std::atomic_ref<T>(destination[i]).store(source[i], std::memory_order::relaxed);
+            }
+        }
+    };
+
+    /**
+     * reads the same number of samples from N readers, e.g. the pre and post rings of an analyzer,
+     * so that the signals stay aligned
+     * when one reader has been overrun, all of them skip to their newest sample
+     * @tparam T the type of elements
+     * @tparam N the number of readers
+     */
+    template<typename T, size_t N>
+    class BroadcastReaderGroup {
+    public:
+        using Reader = typename BroadcastRing<T>::Reader;
+
+        BroadcastReaderGroup() = default;
+
+        /**
+         * call before reading, not real-time safe
+         * @param readers the readers, which must outlive the group
+         * @param block_size the maximum number of samples per channel of one read
+         */
+        void prepare(std::array<Reader *, N> readers, const size_t block_size) {
+            readers_ = readers;
+            block_size_ = block_size;
+            for (size_t i = 0; i < N; ++i) {
+                data_[i].resize(readers_[i]->getNumChannels());
+                pointers_[i].resize(data_[i].size());
+                for (size_t chan = 0; chan < data_[i].size(); ++chan) {
+                    data_[i][chan].resize(block_size_);
+                    pointers_[i][chan] = data_[i][chan].data();
+                }
+            }
+        }
+
+        /**
+         * read the next block of every reader, only the thread that owns the readers may call this
+         * @return the number of samples per channel read, 0 if nothing is ready or a reader has been overrun
+         */
+        size_t read() {
+            size_t num = block_size_;
+            for (auto *reader: readers_) {
+                num = std::min(num, reader->getNumReady());
+            }
+            if (num == 0) return 0;
+            const auto position = readers_[0]->getPosition();
+            for (size_t i = 0; i < N; ++i) {
+                if (readers_[i]->read(getBuffer(i), num) != num) {
+                    // the readers are aligned again at their newest sample, the samples in between are lost
+                    for (auto *reader: readers_) {
+                        reader->resync();
+                    }
+                    // the position only moves backwards if the ring has been prepared again
+                    num_skipped_ += std::max(readers_[0]->getPosition(), position) - position;
+                    return 0;
+                }
+            }
+            return num;
+        }
+
+        /**
+         * @param idx
+         * @return the buffer of the idx-th reader
+         */
+        std::span<T *> getBuffer(const size_t idx) {
+            return {pointers_[idx].data(), pointers_[idx].size()};
+        }
+
+        /**
+         * @return the number of samples per channel skipped due to overruns since the last call
+         */
+        std::uint64_t popNumSkipped() {
+            return std::exchange(num_skipped_, 0);
+        }
+
+    private:
+        std::array<Reader *, N> readers_{};
+        size_t block_size_{0};
+        std::array<std::vector<std::vector<T> >, N> data_{};
+        std::array<std::vector<T *>, N> pointers_{};
+        std::uint64_t num_skipped_{0};
+    };
+}
@@ -13,3 +13,4 @@
 #include "circular_buffer.hpp"
 #include "circular_minmax_buffer.hpp"
 #include "abstract_fifo.hpp"
+#include "broadcast_ring.hpp"
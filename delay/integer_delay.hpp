@@ -13,11 +13,16 @@
 #include <algorithm>
 
 #include "../vector/vector.hpp"
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
 
 namespace zldsp::delay {
     template<typename FloatType>
     class IntegerDelay {
     public:
+        // the maximum number of samples written to the states at once, any block size is accepted
+        static constexpr size_t kSubBlockSize = 4096;
+
         IntegerDelay() = default;
 
         void reset() {
@@ -33,44 +38,44 @@ namespace zldsp::delay {
                      const size_t max_num_samples,
                      const size_t num_channels,
                      const FloatType maximum_delay_seconds) {
+            process_counter_.prepare("zldsp::delay::IntegerDelay::process", this);
+            interleaved_counter_.prepare("zldsp::delay::IntegerDelay::processInterleaved", this);
             sample_rate_ = sample_rate;
             delay_seconds_ = std::min(delay_seconds_, maximum_delay_seconds);
             const auto maximum_delay_samples = static_cast<double>(maximum_delay_seconds) * sample_rate;
-            capacity_ = static_cast<int>(std::ceil(maximum_delay_samples)) + static_cast<int>(max_num_samples) + 1;
+            // the states only have to hold one sub-block on top of the delay
+            sub_block_size_ = std::clamp(max_num_samples, static_cast<size_t>(1), kSubBlockSize);
+            capacity_ = static_cast<int>(std::ceil(maximum_delay_samples)) + static_cast<int>(sub_block_size_) + 1;
             states_.resize(num_channels);
 
             reset();
         }
 
-        void process(std::span<FloatType *> input, size_t num_samples) {
-            // write input samples to states
-            const auto next_tail = (tail_ + static_cast<int>(num_samples)) % capacity_;
-            if (next_tail > tail_) {
-                for (size_t chan = 0; chan < input.size(); ++chan) {
-                    vector::copy(states_[chan].data() + static_cast<size_t>(tail_), input[chan], num_samples);
-                }
-            } else {
-                const auto block1_size = static_cast<size_t>(capacity_ - tail_);
-                for (size_t chan = 0; chan < input.size(); ++chan) {
-                    vector::copy(states_[chan].data() + static_cast<size_t>(tail_), input[chan], block1_size);
-                    vector::copy(states_[chan].data(), input[chan] + block1_size, static_cast<size_t>(next_tail));
-                }
+        /**
+         * @param input
+         * @param num_samples any number of samples, larger blocks are processed in sub-blocks
+         */
+        void process(std::span<FloatType *> input, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::delay::IntegerDelay::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            for (size_t start = 0; start < num_samples; start += sub_block_size_) {
+                processBlock(input, start, std::min(num_samples - start, sub_block_size_));
             }
-            tail_ = next_tail;
-            // write states to input samples
-            const auto next_head = (head_ + static_cast<int>(num_samples)) % capacity_;
-            if (next_head > head_) {
-                for (size_t chan = 0; chan < input.size(); ++chan) {
-                    vector::copy(input[chan], states_[chan].data() + static_cast<size_t>(head_), num_samples);
-                }
-            } else {
-                const auto block1_size = static_cast<size_t>(capacity_ - head_);
-                for (size_t chan = 0; chan < input.size(); ++chan) {
-                    vector::copy(input[chan], states_[chan].data() + static_cast<size_t>(head_), block1_size);
-                    vector::copy(input[chan] + block1_size, states_[chan].data(), static_cast<size_t>(next_head));
-                }
+        }
+
+        /**
+         * process an interleaved buffer in place
+         * @param buffer num_samples frames of num_channels samples
+         * @param num_channels at most the number of channels given to prepare
+         * @param num_samples the number of frames, larger blocks are processed in sub-blocks
+         */
+        void processInterleaved(FloatType *buffer, const size_t num_channels, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::delay::IntegerDelay::processInterleaved");
+            ZLDSP_CYCLE_COUNTER(interleaved_counter_, num_samples);
+            for (size_t start = 0; start < num_samples; start += sub_block_size_) {
+                processInterleavedBlock(buffer + start * num_channels, num_channels,
+                                        std::min(num_samples - start, sub_block_size_));
             }
-            head_ = next_head;
         }
 
         void setDelay(const FloatType delay_seconds) {
@@ -101,8 +106,72 @@ namespace zldsp::delay {
 
     private:
         double sample_rate_{48000.0};
+        chore::CycleCounter process_counter_, interleaved_counter_;
         FloatType delay_seconds_{0};
         int capacity_{0}, head_{0}, tail_{0};
+        size_t sub_block_size_{1};
         std::vector<std::vector<FloatType> > states_;
+
+        void processBlock(std::span<FloatType *> input, const size_t offset, const size_t num_samples) {
+            // write input samples to states
+            const auto next_tail = (tail_ + static_cast<int>(num_samples)) % capacity_;
+            if (next_tail > tail_) {
+                for (size_t chan = 0; chan < input.size(); ++chan) {
+                    vector::copy(states_[chan].data() + static_cast<size_t>(tail_), input[chan] + offset, num_samples);
+                }
+            } else {
+                const auto block1_size = static_cast<size_t>(capacity_ - tail_);
+                for (size_t chan = 0; chan < input.size(); ++chan) {
+                    vector::copy(states_[chan].data() + static_cast<size_t>(tail_), input[chan] + offset, block1_size);
+                    vector::copy(states_[chan].data(), input[chan] + offset + block1_size, static_cast<size_t>(next_tail));
+                }
+            }
+            tail_ = next_tail;
+            // write states to input samples
+            const auto next_head = (head_ + static_cast<int>(num_samples)) % capacity_;
+            if (next_head > head_) {
+                for (size_t chan = 0; chan < input.size(); ++chan) {
+                    vector::copy(input[chan] + offset, states_[chan].data() + static_cast<size_t>(head_), num_samples);
+                }
+            } else {
+                const auto block1_size = static_cast<size_t>(capacity_ - head_);
+                for (size_t chan = 0; chan < input.size(); ++chan) {
+                    vector::copy(input[chan] + offset, states_[chan].data() + static_cast<size_t>(head_), block1_size);
+                    vector::copy(input[chan] + offset + block1_size, states_[chan].data(), static_cast<size_t>(next_head));
+                }
+            }
+            head_ = next_head;
+        }
+
+        void processInterleavedBlock(FloatType *frames, const size_t num_channels, const size_t num_samples) {
+            // write input frames to states
+            const auto next_tail = (tail_ + static_cast<int>(num_samples)) % capacity_;
+            const auto tail_size1 = std::min(num_samples, static_cast<size_t>(capacity_ - tail_));
+            for (size_t chan = 0; chan < num_channels; ++chan) {
+                auto *state = states_[chan].data();
+                const auto *input = frames + chan;
+                for (size_t i = 0; i < tail_size1; ++i) {
+                    state[static_cast<size_t>(tail_) + i] = input[i * num_channels];
+                }
+                for (size_t i = tail_size1; i < num_samples; ++i) {
+                    state[i - tail_size1] = input[i * num_channels];
+                }
+            }
+            tail_ = next_tail;
+            // write states to output frames
+            const auto next_head = (head_ + static_cast<int>(num_samples)) % capacity_;
+            const auto head_size1 = std::min(num_samples, static_cast<size_t>(capacity_ - head_));
+            for (size_t chan = 0; chan < num_channels; ++chan) {
+                const auto *state = states_[chan].data();
+                auto *output = frames + chan;
+                for (size_t i = 0; i < head_size1; ++i) {
+                    output[i * num_channels] = state[static_cast<size_t>(head_) + i];
+                }
+                for (size_t i = head_size1; i < num_samples; ++i) {
+                    output[i * num_channels] = state[i - head_size1];
+                }
+            }
+            head_ = next_head;
+        }
     };
 }
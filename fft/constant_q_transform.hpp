@@ -0,0 +1,261 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "kfr_engine.hpp"
+#include "../over_sample/over_sample_stage.hpp"
+#include "../over_sample/halfband_coeffs.hpp"
+
+namespace zldsp::fft {
+    /**
+     * a multirate constant-Q transform with the sparse spectral kernel method
+     * the input is decimated by 2 per octave with half-band stages, and each octave keeps its latest 2^order samples
+     * each output frequency f_k is evaluated in the highest octave whose history holds its window,
+     * a Hann window of length Q * sr / f_k at the sample rate of that octave, aligned to the end of the history,
+     * so every output reflects the latest samples and the transform stays constant-Q down to the lowest frequency
+     * the spectral kernels are computed once per order and only values above a threshold are kept,
+     * so a transform costs one real FFT per octave plus a sparse complex dot product per output
+     * the output scale matches a Hann-windowed FFT normalized by the FFT size, i.e. a full-scale sine gives 1/4
+     * the group delays of the octaves differ, which does not matter for metering
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class ConstantQTransform {
+    public:
+        static constexpr size_t kMaxOctaveNum = 12;
+        // the highest frequency of a decimated octave relative to its sample rate, below the half-band passband edge
+        static constexpr double kMaxEdge = 0.4;
+
+        ConstantQTransform() = default;
+
+        /**
+         * call before processing starts
+         * @param order the FFT size (and the history size of each octave) is 2^order
+         * @param sample_rate
+         * @param freqs the output frequencies in Hz
+         * @param q the quality factor, i.e. window length in periods
+         * @param threshold kernel values below threshold * the kernel peak are dropped
+         */
+        void prepare(const size_t order, const double sample_rate,
+                     std::span<const FloatType> freqs, const double q, const double threshold = 1e-3) {
+            fft_.setOrder(order);
+            const auto fft_size = fft_.getSize();
+            const auto bin_size = fft_size / 2 + 1;
+            time_buffer_.resize(fft_size);
+            spectrum_.resize(bin_size);
+
+            // the highest octave whose history holds the window, as long as the frequency stays in its passband
+            std::vector<size_t> octaves(freqs.size());
+            size_t octave_num = 1;
+            for (size_t k = 0; k < freqs.size(); ++k) {
+                const auto freq = static_cast<double>(freqs[k]);
+                size_t octave = 0;
+                while (octave + 1 < kMaxOctaveNum
+                       && q * sample_rate / (freq * static_cast<double>(1 << octave)) > static_cast<double>(fft_size)
+                       && freq <= kMaxEdge * sample_rate / static_cast<double>(1 << (octave + 1))) {
+                    octave += 1;
+                }
+                octaves[k] = octave;
+                octave_num = std::max(octave_num, octave + 1);
+            }
+
+            stages_.clear();
+            for (size_t octave = 1; octave < octave_num; ++octave) {
+                stages_.emplace_back(std::span(kHalfbandCoeff), std::span(kHalfbandCoeff));
+                stages_.back().prepare(1, fft_size);
+            }
+            histories_.resize(octave_num);
+            for (auto &history: histories_) {
+                history.resize(fft_size);
+            }
+            carries_.resize(octave_num);
+            decimated_.resize(fft_size / 2 + 1);
+            reset();
+
+            std::vector<FloatType> cos_kernel(fft_size), sin_kernel(fft_size);
+            std::vector<std::complex<FloatType> > cos_spectrum(bin_size), sin_spectrum(bin_size);
+            std::vector<std::complex<double> > kernel(bin_size);
+            octave_starts_.clear();
+            outputs_.clear();
+            starts_.clear();
+            indices_.clear();
+            kernel_reals_.clear();
+            kernel_imags_.clear();
+            octave_starts_.reserve(octave_num + 1);
+            outputs_.reserve(freqs.size());
+            starts_.reserve(freqs.size() + 1);
+            starts_.push_back(0);
+            // the rows are grouped by octave, so that each octave runs one FFT
+            for (size_t octave = 0; octave < octave_num; ++octave) {
+                octave_starts_.push_back(outputs_.size());
+                const auto octave_sample_rate = sample_rate / static_cast<double>(1 << octave);
+                for (size_t k = 0; k < freqs.size(); ++k) {
+                    if (octaves[k] != octave) continue;
+                    const auto freq = static_cast<double>(freqs[k]);
+                    const auto omega = 2.0 * std::numbers::pi * freq / octave_sample_rate;
+                    const auto length = std::clamp(static_cast<size_t>(std::round(q * octave_sample_rate / freq)),
+                                                   static_cast<size_t>(4), fft_size);
+                    const auto offset = fft_size - length;
+                    std::fill(cos_kernel.begin(), cos_kernel.end(), FloatType(0));
+                    std::fill(sin_kernel.begin(), sin_kernel.end(), FloatType(0));
+                    // temporal kernel w[n] / length * e^{j * omega * n}, the 1/length keeps the scale of an FFT / N
+                    for (size_t n = 0; n < length; ++n) {
+                        const auto w = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(n) /
+                                                            static_cast<double>(length));
+                        const auto phase = omega * static_cast<double>(n);
+                        cos_kernel[offset + n] = static_cast<FloatType>(
+                            w * std::cos(phase) / static_cast<double>(length));
+                        sin_kernel[offset + n] = static_cast<FloatType>(
+                            w * std::sin(phase) / static_cast<double>(length));
+                    }
+                    fft_.forward(cos_kernel.data(), cos_spectrum.data());
+                    fft_.forward(sin_kernel.data(), sin_spectrum.data());
+                    // spectral kernel conj(FFT(real + j * imag)) / N, so that sum_j X[j] * K[j] = sum_n x[n] * conj(t[n])
+                    double peak = 0.0;
+                    for (size_t j = 0; j < bin_size; ++j) {
+                        const auto c = std::complex<double>(cos_spectrum[j]), s = std::complex<double>(sin_spectrum[j]);
+                        kernel[j] = std::conj(c + std::complex<double>(0.0, 1.0) * s) / static_cast<double>(fft_size);
+                        peak = std::max(peak, std::abs(kernel[j]));
+                    }
+                    for (size_t j = 0; j < bin_size; ++j) {
+                        if (std::abs(kernel[j]) <= peak * threshold) continue;
+                        indices_.push_back(j);
+                        kernel_reals_.push_back(static_cast<FloatType>(kernel[j].real()));
+                        kernel_imags_.push_back(static_cast<FloatType>(kernel[j].imag()));
+                    }
+                    starts_.push_back(indices_.size());
+                    outputs_.push_back(k);
+                }
+            }
+            octave_starts_.push_back(outputs_.size());
+        }
+
+        /**
+         * clear the histories and the half-band states
+         */
+        void reset() {
+            for (auto &stage: stages_) {
+                stage.reset();
+            }
+            for (auto &history: histories_) {
+                std::fill(history.begin(), history.end(), FloatType(0));
+            }
+            std::fill(carries_.begin(), carries_.end(), static_cast<size_t>(0));
+        }
+
+        /**
+         * push the latest samples into the octave histories
+         * @param samples
+         * @param num_samples
+         */
+        void process(const FloatType *samples, size_t num_samples) {
+            const auto fft_size = fft_.getSize();
+            while (num_samples > 0) {
+                const auto chunk_size = std::min(num_samples, fft_size);
+                pushChunk(samples, chunk_size);
+                samples += chunk_size;
+                num_samples -= chunk_size;
+            }
+        }
+
+        /**
+         * @param magnitudes receives the magnitude of each output frequency of the latest histories
+         */
+        void forwardMagnitude(std::span<FloatType> magnitudes) {
+            for (size_t octave = 0; octave + 1 < octave_starts_.size(); ++octave) {
+                if (octave_starts_[octave] == octave_starts_[octave + 1]) continue;
+                std::copy(histories_[octave].begin(), histories_[octave].end(), time_buffer_.begin());
+                fft_.forward(time_buffer_.data(), spectrum_.data());
+                for (size_t k = octave_starts_[octave]; k < octave_starts_[octave + 1]; ++k) {
+                    FloatType real{0}, imag{0};
+                    for (size_t p = starts_[k]; p < starts_[k + 1]; ++p) {
+                        const auto x = spectrum_[indices_[p]];
+                        real += x.real() * kernel_reals_[p] - x.imag() * kernel_imags_[p];
+                        imag += x.real() * kernel_imags_[p] + x.imag() * kernel_reals_[p];
+                    }
+                    magnitudes[outputs_[k]] = std::sqrt(real * real + imag * imag);
+                }
+            }
+        }
+
+        [[nodiscard]] size_t getSize() const { return fft_.getSize(); }
+
+        [[nodiscard]] size_t getNumFrequencies() const { return outputs_.size(); }
+
+        /**
+         * @return the number of octaves, i.e. the number of FFTs per transform if every octave has outputs
+         */
+        [[nodiscard]] size_t getNumOctaves() const { return histories_.size(); }
+
+        /**
+         * @return the number of non-zero kernel values
+         */
+        [[nodiscard]] size_t getKernelSize() const { return indices_.size(); }
+
+    private:
+        static constexpr std::array kHalfbandCoeff = oversample::halfband_coeff::convert<FloatType>(
+            oversample::halfband_coeff::kCoeff_64_10_100);
+
+        KFREngine<FloatType> fft_;
+        std::vector<FloatType> time_buffer_;
+        std::vector<std::complex<FloatType> > spectrum_;
+        // the stage feeding octave k + 1 from octave k
+        std::vector<oversample::OverSampleStage<FloatType> > stages_;
+        // the latest 2^order samples of each octave
+        std::vector<std::vector<FloatType> > histories_;
+        // whether the stage feeding octave k holds an odd input sample from the last call
+        std::vector<size_t> carries_;
+        std::vector<FloatType> decimated_;
+        // compressed sparse rows, one row per output frequency, grouped by octave
+        std::vector<size_t> octave_starts_, outputs_, starts_, indices_;
+        std::vector<FloatType> kernel_reals_, kernel_imags_;
+
+        /**
+         * push at most 2^order samples into octave 0 and decimate them through the lower octaves
+         */
+        void pushChunk(const FloatType *samples, size_t num_samples) {
+            for (size_t octave = 0; octave < histories_.size() && num_samples > 0; ++octave) {
+                pushHistory(histories_[octave], samples, num_samples);
+                if (octave + 1 == histories_.size()) break;
+                auto &stage{stages_[octave]};
+                auto &os_buffer{stage.getOSBuffer()[0]};
+                const auto carry = carries_[octave + 1];
+                const auto total = carry + num_samples;
+                std::copy(samples, samples + num_samples, os_buffer.begin() + static_cast<std::ptrdiff_t>(carry));
+                const auto down_num_samples = total >> 1;
+                if (down_num_samples > 0) {
+                    std::array<FloatType *, 1> pointers{decimated_.data()};
+                    stage.downsample(std::span(pointers), down_num_samples);
+                }
+                carries_[octave + 1] = total & 1;
+                if (carries_[octave + 1] == 1) {
+                    os_buffer[0] = os_buffer[total - 1];
+                }
+                samples = decimated_.data();
+                num_samples = down_num_samples;
+            }
+        }
+
+        static void pushHistory(std::vector<FloatType> &history, const FloatType *samples, const size_t num_samples) {
+            const auto num_keep = history.size() - num_samples;
+            std::copy(history.begin() + static_cast<std::ptrdiff_t>(num_samples), history.end(), history.begin());
+            std::copy(samples, samples + num_samples, history.begin() + static_cast<std::ptrdiff_t>(num_keep));
+        }
+    };
+}
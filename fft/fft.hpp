@@ -10,3 +10,7 @@
 #pragma once
 
 #include "kfr_engine.hpp"
+#include "window.hpp"
+#include "sliding_dft.hpp"
+#include "goertzel_bank.hpp"
+#include "constant_q_transform.hpp"
@@ -0,0 +1,203 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
+
+namespace zldsp::fft {
+    /**
+     * a generalized Goertzel bank, which measures the spectrum at K arbitrary frequencies over a block
+     * frequencies do not need to be integer bins of the block size
+     * the second-order recursions of all frequencies are stored as separate arrays per channel and run side by side,
+     * so the per-sample update vectorizes across frequencies
+     * the cost is O(K * N), versus O(N log N) for an FFT of a size that resolves the same frequencies
+     * prefer double for long blocks or very low frequencies, where the recursion loses precision
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class GoertzelBank {
+    public:
+        GoertzelBank() = default;
+
+        /**
+         * call before processing starts
+         * @param sample_rate
+         * @param max_block_size the maximum number of samples of a measurement
+         * @param num_channels the number of channels of the multichannel process
+         */
+        void prepare(const double sample_rate, const size_t max_block_size, const size_t num_channels = 1) {
+            process_counter_.prepare("zldsp::fft::GoertzelBank::process", this);
+            sample_rate_ = sample_rate;
+            s1_.resize(num_channels);
+            s2_.resize(num_channels);
+            bins_.resize(num_channels);
+            window_.resize(max_block_size);
+            window_sum_ = static_cast<FloatType>(max_block_size);
+            // keep the window set before prepare
+            updateWindow();
+            setFrequencies(frequencies_);
+        }
+
+        /**
+         * call before processing starts
+         * @param frequencies the target frequencies in Hz
+         */
+        void setFrequencies(std::span<const double> frequencies) {
+            if (frequencies.data() != frequencies_.data()) {
+                frequencies_.assign(frequencies.begin(), frequencies.end());
+            }
+            const auto num = frequencies_.size();
+            omegas_.resize(num);
+            coeffs_.resize(num);
+            for (size_t chan = 0; chan < s1_.size(); ++chan) {
+                s1_[chan].resize(num);
+                s2_[chan].resize(num);
+                bins_[chan].resize(num);
+            }
+            for (size_t k = 0; k < num; ++k) {
+                omegas_[k] = 2.0 * std::numbers::pi * frequencies_[k] / sample_rate_;
+                coeffs_[k] = static_cast<FloatType>(2.0 * std::cos(omegas_[k]));
+            }
+        }
+
+        /**
+         * call before processing starts, either before or after prepare
+         * the window is applied from the first sample of each measurement, an empty window disables windowing
+         * samples beyond the window (or max_block_size) are not weighted
+         * @param window the window, at most max_block_size samples
+         */
+        void setWindow(std::span<const FloatType> window) {
+            requested_window_.assign(window.begin(), window.end());
+            updateWindow();
+        }
+
+        /**
+         * measure a block of the first channel, the results are available after the call
+         * @param buffer
+         * @param num_samples at most max_block_size, and the window size if windowing is enabled
+         */
+        void process(const FloatType *buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::fft::GoertzelBank::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            updateWindowSum(num_samples);
+            processChannel(0, buffer, num_samples);
+        }
+
+        /**
+         * measure a multichannel block, the results of each channel are available after the call
+         * @param buffer at most the number of channels set by prepare
+         * @param num_samples at most max_block_size, and the window size if windowing is enabled
+         */
+        void process(std::span<FloatType *> buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::fft::GoertzelBank::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            updateWindowSum(num_samples);
+            for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                processChannel(chan, buffer[chan], num_samples);
+            }
+        }
+
+        /**
+         * @param chan
+         * @param k
+         * @return the windowed DTFT of the last block of the channel at the k-th frequency
+         */
+        std::complex<double> getBin(const size_t chan, const size_t k) const { return bins_[chan][k]; }
+
+        std::complex<double> getBin(const size_t k) const { return getBin(0, k); }
+
+        /**
+         * @param chan
+         * @param k
+         * @return the amplitude of the channel at the k-th frequency, a full-scale sine gives 1
+         */
+        double getAmplitude(const size_t chan, const size_t k) const {
+            return window_sum_ > FloatType(0)
+                       ? 2.0 * std::abs(bins_[chan][k]) / static_cast<double>(window_sum_)
+                       : 0.0;
+        }
+
+        double getAmplitude(const size_t k) const { return getAmplitude(0, k); }
+
+        /**
+         * @param chan
+         * @param k
+         * @return the phase of the channel at the k-th frequency, relative to a cosine starting at the first sample
+         */
+        double getPhase(const size_t chan, const size_t k) const { return std::arg(bins_[chan][k]); }
+
+        double getPhase(const size_t k) const { return getPhase(0, k); }
+
+        [[nodiscard]] size_t getNumFrequencies() const { return coeffs_.size(); }
+
+        [[nodiscard]] size_t getNumChannels() const { return s1_.size(); }
+
+    private:
+        double sample_rate_{48000.0};
+        std::vector<double> frequencies_, omegas_;
+        std::vector<FloatType> coeffs_;
+        // the recursion states of each channel, one entry per frequency
+        std::vector<std::vector<FloatType> > s1_{1}, s2_{1};
+        std::vector<FloatType> requested_window_, window_;
+        FloatType window_sum_{0};
+        bool is_windowed_{false};
+        std::vector<std::vector<std::complex<double> > > bins_{1};
+        chore::CycleCounter process_counter_;
+
+        void updateWindowSum(const size_t num_samples) {
+            window_sum_ = FloatType(0);
+            for (size_t i = 0; i < num_samples; ++i) {
+                window_sum_ += is_windowed_ && i < window_.size() ? window_[i] : FloatType(1);
+            }
+        }
+
+        void processChannel(const size_t chan, const FloatType *buffer, const size_t num_samples) {
+            const auto num = coeffs_.size();
+            auto *s1s = s1_[chan].data();
+            auto *s2s = s2_[chan].data();
+            std::fill(s1s, s1s + num, FloatType(0));
+            std::fill(s2s, s2s + num, FloatType(0));
+            for (size_t i = 0; i < num_samples; ++i) {
+                const auto w = is_windowed_ && i < window_.size() ? window_[i] : FloatType(1);
+                const auto x = buffer[i] * w;
+                for (size_t k = 0; k < num; ++k) {
+                    const auto s0 = x + coeffs_[k] * s1s[k] - s2s[k];
+                    s2s[k] = s1s[k];
+                    s1s[k] = s0;
+                }
+            }
+            // y = s1 - e^{-jw} * s2, then shift the phase so that the first sample sits at time 0
+            const auto last = static_cast<double>(num_samples) - 1.0;
+            auto &bins{bins_[chan]};
+            for (size_t k = 0; k < num; ++k) {
+                const auto w = omegas_[k];
+                const auto s1 = static_cast<double>(s1s[k]), s2 = static_cast<double>(s2s[k]);
+                const std::complex<double> y{s1 - std::cos(w) * s2, std::sin(w) * s2};
+                bins[k] = y * std::polar(1.0, -w * last);
+            }
+        }
+
+        void updateWindow() {
+            is_windowed_ = !requested_window_.empty();
+            std::fill(window_.begin(), window_.end(), FloatType(1));
+            const auto num = std::min(requested_window_.size(), window_.size());
+            std::copy(requested_window_.begin(), requested_window_.begin() + static_cast<std::ptrdiff_t>(num),
+                      window_.begin());
+        }
+    };
+}
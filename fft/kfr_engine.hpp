@@ -19,7 +19,7 @@
 namespace zldsp::fft {
     template<typename FloatType>
     void fillCycleHanningWindow(kfr::univector<FloatType> &window, const size_t size) {
-        kfr::univector<float> temp_window;
+        kfr::univector<FloatType> temp_window;
         temp_window.resize(size + 1);
         temp_window = kfr::window_hann<FloatType>(size + 1);
         auto actual_window = kfr::make_univector(temp_window.data(), size);
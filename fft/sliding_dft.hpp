@@ -0,0 +1,234 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
+
+namespace zldsp::fft {
+    /**
+     * a modulated sliding DFT (mSDFT) bank, which updates a set of DFT bins every sample
+     * instead of rotating each bin by a twiddle factor every sample (whose pole sits on the unit circle),
+     * the input difference is modulated and accumulated, so rounding errors do not grow exponentially
+     * bin states are stored as separate real/imag arrays per channel, and the twiddles of each sample are gathered once
+     * into contiguous arrays shared by all channels, so the per-sample update vectorizes across bins
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class SlidingDFT {
+    public:
+        SlidingDFT() = default;
+
+        /**
+         * call before processing starts
+         * @param order the DFT size is 2^order
+         */
+        void setOrder(const size_t order) {
+            process_counter_.prepare("zldsp::fft::SlidingDFT::process", this);
+            dft_size_ = static_cast<size_t>(1) << order;
+            mask_ = static_cast<std::uint32_t>(dft_size_ - 1);
+            amplitude_scale_ = FloatType(2) / static_cast<FloatType>(dft_size_);
+            cos_table_.resize(dft_size_);
+            sin_table_.resize(dft_size_);
+            for (size_t i = 0; i < dft_size_; ++i) {
+                const auto phase = 2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(dft_size_);
+                cos_table_[i] = static_cast<FloatType>(std::cos(phase));
+                sin_table_[i] = static_cast<FloatType>(std::sin(phase));
+            }
+            for (auto &input_buffer: input_buffers_) {
+                input_buffer.resize(dft_size_);
+            }
+            reset();
+        }
+
+        /**
+         * call before processing starts
+         * @param num_channels the number of channels of the multichannel process
+         */
+        void setNumChannels(const size_t num_channels) {
+            input_buffers_.resize(num_channels);
+            for (auto &input_buffer: input_buffers_) {
+                input_buffer.resize(dft_size_);
+            }
+            reals_.resize(num_channels);
+            imags_.resize(num_channels);
+            for (size_t chan = 0; chan < num_channels; ++chan) {
+                reals_[chan].resize(steps_.size());
+                imags_[chan].resize(steps_.size());
+            }
+            reset();
+        }
+
+        /**
+         * call before processing starts
+         * @param bins the bin indices, each one is wrapped into [0, DFT size)
+         */
+        void setBins(std::span<const size_t> bins) {
+            steps_.resize(bins.size());
+            for (size_t k = 0; k < bins.size(); ++k) {
+                steps_[k] = static_cast<std::uint32_t>(bins[k]) & mask_;
+            }
+            for (size_t chan = 0; chan < reals_.size(); ++chan) {
+                reals_[chan].resize(bins.size());
+                imags_[chan].resize(bins.size());
+            }
+            cos_twiddles_.resize(bins.size());
+            sin_twiddles_.resize(bins.size());
+            phase_indices_.resize(bins.size());
+            reset();
+        }
+
+        void reset() {
+            for (size_t chan = 0; chan < input_buffers_.size(); ++chan) {
+                std::fill(input_buffers_[chan].begin(), input_buffers_[chan].end(), FloatType(0));
+                std::fill(reals_[chan].begin(), reals_[chan].end(), FloatType(0));
+                std::fill(imags_[chan].begin(), imags_[chan].end(), FloatType(0));
+            }
+            std::fill(phase_indices_.begin(), phase_indices_.end(), std::uint32_t(0));
+            pos_ = 0;
+        }
+
+        /**
+         * push a sample of the first channel and update all bins
+         * @param x
+         */
+        void processSample(const FloatType x) {
+            loadTwiddles();
+            updateChannel(0, x);
+            pos_ = (pos_ + 1) & static_cast<size_t>(mask_);
+        }
+
+        /**
+         * push a buffer, the bins are available after the call
+         * @param buffer
+         * @param num_samples
+         */
+        void process(const FloatType *buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::fft::SlidingDFT::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            for (size_t i = 0; i < num_samples; ++i) {
+                processSample(buffer[i]);
+            }
+        }
+
+        /**
+         * push a multichannel buffer, the bins of each channel are available after the call
+         * @param buffer at most the number of channels set by setNumChannels
+         * @param num_samples
+         */
+        void process(std::span<FloatType *> buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::fft::SlidingDFT::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            for (size_t i = 0; i < num_samples; ++i) {
+                loadTwiddles();
+                for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                    updateChannel(chan, buffer[chan][i]);
+                }
+                pos_ = (pos_ + 1) & static_cast<size_t>(mask_);
+            }
+        }
+
+        /**
+         * push a buffer of the first channel and write the per-sample amplitude of each bin
+         * @param buffer
+         * @param amplitudes amplitudes[k] receives num_samples amplitudes of the k-th bin
+         * @param num_samples
+         */
+        void process(const FloatType *buffer, std::span<FloatType *> amplitudes, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::fft::SlidingDFT::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            for (size_t i = 0; i < num_samples; ++i) {
+                processSample(buffer[i]);
+                for (size_t k = 0; k < steps_.size(); ++k) {
+                    amplitudes[k][i] = getAmplitude(0, k);
+                }
+            }
+        }
+
+        /**
+         * @param chan
+         * @param k
+         * @return the amplitude of the k-th bin of the channel, a full-scale sine at the bin center gives 1
+         */
+        FloatType getAmplitude(const size_t chan, const size_t k) const {
+            const auto real = reals_[chan][k], imag = imags_[chan][k];
+            return std::sqrt(real * real + imag * imag) * amplitude_scale_;
+        }
+
+        FloatType getAmplitude(const size_t k) const { return getAmplitude(0, k); }
+
+        /**
+         * @param chan
+         * @param k
+         * @return the DFT of the last 2^order samples of the channel at the k-th bin, with the oldest sample at time 0
+         */
+        std::complex<FloatType> getBin(const size_t chan, const size_t k) const {
+            // demodulate the accumulated state
+            const auto idx = phase_indices_[k];
+            const std::complex<FloatType> y{reals_[chan][k], imags_[chan][k]};
+            return y * std::complex<FloatType>{cos_table_[idx], sin_table_[idx]};
+        }
+
+        std::complex<FloatType> getBin(const size_t k) const { return getBin(0, k); }
+
+        [[nodiscard]] size_t getSize() const { return dft_size_; }
+
+        [[nodiscard]] size_t getNumBins() const { return steps_.size(); }
+
+        [[nodiscard]] size_t getNumChannels() const { return input_buffers_.size(); }
+
+    private:
+        size_t dft_size_{0};
+        std::uint32_t mask_{0};
+        FloatType amplitude_scale_{0};
+        std::vector<FloatType> cos_table_, sin_table_;
+        // the last 2^order samples of each channel
+        std::vector<std::vector<FloatType> > input_buffers_{1};
+        size_t pos_{0};
+        // the accumulated states of each channel, one entry per bin
+        std::vector<std::vector<FloatType> > reals_{1}, imags_{1};
+        // the twiddles of the current sample, gathered from the tables and shared by all channels
+        std::vector<FloatType> cos_twiddles_, sin_twiddles_;
+        std::vector<std::uint32_t> steps_, phase_indices_;
+        chore::CycleCounter process_counter_;
+
+        /**
+         * gather the twiddles of the current sample and advance the phases
+         */
+        void loadTwiddles() {
+            for (size_t k = 0; k < steps_.size(); ++k) {
+                const auto idx = phase_indices_[k];
+                cos_twiddles_[k] = cos_table_[idx];
+                sin_twiddles_[k] = sin_table_[idx];
+                phase_indices_[k] = (idx + steps_[k]) & mask_;
+            }
+        }
+
+        void updateChannel(const size_t chan, const FloatType x) {
+            auto &input_buffer{input_buffers_[chan]};
+            const auto delta = x - input_buffer[pos_];
+            input_buffer[pos_] = x;
+            auto *reals = reals_[chan].data();
+            auto *imags = imags_[chan].data();
+            for (size_t k = 0; k < steps_.size(); ++k) {
+                reals[k] += delta * cos_twiddles_[k];
+                imags[k] -= delta * sin_twiddles_[k];
+            }
+        }
+    };
+}
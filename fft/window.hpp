@@ -0,0 +1,183 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <span>
+#include <tuple>
+
+#include "../vector/kfr_import.hpp"
+
+namespace zldsp::fft {
+    enum class WindowType {
+        kRectangular, kHann, kBlackmanHarris, kFlatTop, kKaiser, kGaussian
+    };
+
+    namespace window_coeff {
+        // cosine-sum coefficients a_k of w[n] = sum_k (-1)^k * a_k * cos(2 * pi * k * n / M)
+        inline constexpr std::array<double, 2> kHann{0.5, 0.5};
+        inline constexpr std::array<double, 4> kBlackmanHarris{0.35875, 0.48829, 0.14128, 0.01168};
+        inline constexpr std::array<double, 5> kFlatTop{
+            0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368
+        };
+
+        /**
+         * @param x
+         * @return the zeroth-order modified Bessel function of the first kind
+         */
+        inline double besselI0(const double x) {
+            double sum{1.0}, term{1.0};
+            const auto half_x_square = 0.25 * x * x;
+            for (int k = 1; k < 64; ++k) {
+                term *= half_x_square / static_cast<double>(k * k);
+                sum += term;
+                if (term < sum * 1e-17) break;
+            }
+            return sum;
+        }
+    }
+
+    /**
+     * an immutable window with its normalization constants
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class Window {
+    public:
+        /**
+         * @param type
+         * @param size
+         * @param periodic periodic windows are for spectral analysis (the period is size), symmetric ones for filter design
+         * @param param beta for Kaiser, sigma (relative to half the size) for Gaussian, ignored otherwise
+         */
+        Window(const WindowType type, const size_t size, const bool periodic, const double param = 0.0)
+            : data_(size) {
+            const auto period = static_cast<double>(periodic ? size : std::max(size, static_cast<size_t>(2)) - 1);
+            for (size_t n = 0; n < size; ++n) {
+                data_[n] = static_cast<FloatType>(getValue(type, static_cast<double>(n), period, param));
+            }
+            double sum{0.0}, square_sum{0.0};
+            for (size_t n = 0; n < size; ++n) {
+                const auto w = static_cast<double>(data_[n]);
+                sum += w;
+                square_sum += w * w;
+            }
+            const auto num = static_cast<double>(std::max(size, static_cast<size_t>(1)));
+            coherent_gain_ = static_cast<FloatType>(sum / num);
+            power_gain_ = static_cast<FloatType>(square_sum / num);
+            enbw_ = sum > 0.0 ? static_cast<FloatType>(num * square_sum / (sum * sum)) : FloatType(0);
+        }
+
+        const kfr::univector<FloatType> &getData() const { return data_; }
+
+        [[nodiscard]] size_t size() const { return data_.size(); }
+
+        /**
+         * @return sum(w) / N, the amplitude scale of a sine at a bin center
+         */
+        FloatType getCoherentGain() const { return coherent_gain_; }
+
+        /**
+         * @return sum(w^2) / N, the power scale of noise
+         */
+        FloatType getPowerGain() const { return power_gain_; }
+
+        /**
+         * @return the equivalent noise bandwidth in bins
+         */
+        FloatType getENBW() const { return enbw_; }
+
+    private:
+        kfr::univector<FloatType> data_;
+        FloatType coherent_gain_{0}, power_gain_{0}, enbw_{0};
+
+        template<size_t N>
+        static double getCosineSum(const std::array<double, N> &coeffs, const double n, const double period) {
+            const auto phase = 2.0 * std::numbers::pi * n / period;
+            double w{0.0}, sign{1.0};
+            for (size_t k = 0; k < N; ++k) {
+                w += sign * coeffs[k] * std::cos(phase * static_cast<double>(k));
+                sign = -sign;
+            }
+            return w;
+        }
+
+        static double getValue(const WindowType type, const double n, const double period, const double param) {
+            switch (type) {
+                case WindowType::kHann:
+                    return getCosineSum(window_coeff::kHann, n, period);
+                case WindowType::kBlackmanHarris:
+                    return getCosineSum(window_coeff::kBlackmanHarris, n, period);
+                case WindowType::kFlatTop:
+                    return getCosineSum(window_coeff::kFlatTop, n, period);
+                case WindowType::kKaiser: {
+                    const auto x = 2.0 * n / period - 1.0;
+                    return window_coeff::besselI0(param * std::sqrt(std::max(0.0, 1.0 - x * x))) /
+                           window_coeff::besselI0(param);
+                }
+                case WindowType::kGaussian: {
+                    const auto x = (n - 0.5 * period) / (0.5 * period * std::max(param, 1e-3));
+                    return std::exp(-0.5 * x * x);
+                }
+                case WindowType::kRectangular:
+                default:
+                    return 1.0;
+            }
+        }
+    };
+
+    /**
+     * a process-wide cache of windows, instances with the same window share one copy
+     * call get at prepare time only, it locks a mutex and may allocate
+     * a window is released when the last instance drops it
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class WindowCache {
+    public:
+        static WindowCache &getInstance() {
+            static WindowCache cache;
+            return cache;
+        }
+
+        std::shared_ptr<const Window<FloatType> > get(const WindowType type, const size_t size,
+                                                      const bool periodic, const double param = 0.0) {
+            const auto key = std::make_tuple(type, size, periodic, param);
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (auto window = windows_[key].lock()) {
+                return window;
+            }
+            // the entries of released windows would otherwise pile up, e.g. while the FFT order is changed
+            std::erase_if(windows_, [](const auto &entry) { return entry.second.expired(); });
+            auto window = std::make_shared<const Window<FloatType> >(type, size, periodic, param);
+            windows_[key] = window;
+            return window;
+        }
+
+        /**
+         * @return the number of cached entries, including the ones whose window has been released
+         */
+        size_t getNumEntries() {
+            std::lock_guard<std::mutex> lock{mutex_};
+            return windows_.size();
+        }
+
+    private:
+        std::mutex mutex_;
+        std::map<std::tuple<WindowType, size_t, bool, double>, std::weak_ptr<const Window<FloatType> > > windows_;
+
+        WindowCache() = default;
+    };
+}
@@ -10,3 +10,4 @@
 #pragma once
 
 #include "multiple_fft_analyzer.hpp"
+#include "onset_detector.hpp"
@@ -47,9 +47,9 @@ namespace zldsp::analyzer {
          * @param min_db
          */
         void createPathYs(std::array<std::span<float>, FFTNum> ys, const float height, const float min_db = -72.f) {
-            std::vector<size_t> is_on_vector{};
+            zldsp::container::FixedMaxSizeArray<size_t, FFTNum> is_on_vector{};
             for (size_t i = 0; i < FFTNum; ++i) {
-                if (this->is_on_[i].load(std::memory_order::relaxed)) is_on_vector.push_back(i);
+                if (this->is_on_[i].load(std::memory_order::relaxed)) is_on_vector.push(i);
             }
             const auto scale = height / min_db;
             for (const auto &i: is_on_vector) {
@@ -10,12 +10,16 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <span>
 
 #include "../container/container.hpp"
 #include "../interpolation/interpolation.hpp"
 #include "../fft/fft.hpp"
 #include "../chore/decibels.hpp"
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
+#include "onset_detector.hpp"
 
 namespace zldsp::analyzer {
     /**
@@ -58,6 +62,7 @@ namespace zldsp::analyzer {
 
 
         void prepare(const double sample_rate) {
+            process_counter_.prepare("zldsp::analyzer::MultipleFFTBase::process", this);
             sample_rate_.store(static_cast<float>(sample_rate));
             if (sample_rate <= 50000) {
                 setOrder(static_cast<int>(default_fft_order_));
@@ -84,37 +89,89 @@ namespace zldsp::analyzer {
          * @param num_samples
          */
         void process(std::array<std::span<FloatType *>, FFTNum> buffers, const size_t num_samples) {
-            int free_space = abstract_fifo_.getNumFree();
-            for (size_t i = 0; i < FFTNum; ++i) {
-                if (!is_on_[i].load(std::memory_order::relaxed)) continue;
-                free_space = std::min(free_space, static_cast<int>(num_samples));
+            ZLDSP_REALTIME_SCOPE("zldsp::analyzer::MultipleFFTBase::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            flushDropMark();
+            const auto plan = abstract_fifo_.planWrite(static_cast<int>(num_samples));
+            if (plan.num_to_write < static_cast<int>(num_samples)) {
+                // keep onset timestamps aligned with the audio when the FIFO overflows
+                // kOverwriteOldest drops the head of the block, the other policies drop (or thin out) its tail
+                const auto num_drop = static_cast<std::uint64_t>(num_samples - static_cast<size_t>(plan.num_to_write));
+                markDrop(plan.offset > 0
+                             ? write_count_
+                             : write_count_ + static_cast<std::uint64_t>(plan.num_to_write), num_drop);
             }
-            if (free_space == 0) { return; }
-            const auto range = abstract_fifo_.prepareToWrite(free_space);
+            if (plan.num_to_write == 0) { return; }
+            const auto range = abstract_fifo_.prepareToWrite(plan.num_to_write);
             for (size_t i = 0; i < FFTNum; ++i) {
                 if (!is_on_[i].load()) continue;
-                int j = 0;
                 const auto buffer = buffers[i];
-                int shift = 0;
-                for (; j < range.block_size1; ++j) {
+                auto j = static_cast<size_t>(plan.offset);
+                const auto step = static_cast<size_t>(plan.step);
+                for (int k = 0; k < range.block_size1 + range.block_size2; ++k) {
                     FloatType sample{0};
                     for (size_t channel = 0; channel < buffer.size(); ++channel) {
-                        sample += buffer[channel][static_cast<size_t>(j)];
+                        sample += buffer[channel][j];
                     }
-                    sample_fifos_[i][static_cast<size_t>(shift + range.start_index1)] = static_cast<float>(sample);
-                    shift += 1;
+                    const auto idx = k < range.block_size1
+                                         ? range.start_index1 + k
+                                         : range.start_index2 + k - range.block_size1;
+                    sample_fifos_[i][static_cast<size_t>(idx)] = static_cast<float>(sample);
+                    j += step;
                 }
-                shift = 0;
-                for (; j < range.block_size1 + range.block_size2; ++j) {
-                    FloatType sample{0};
-                    for (size_t channel = 0; channel < buffer.size(); ++channel) {
-                        sample += buffer[channel][static_cast<size_t>(j)];
-                    }
-                    sample_fifos_[i][static_cast<size_t>(shift + range.start_index2)] = static_cast<float>(sample);
-                    shift += 1;
+            }
+            abstract_fifo_.finishWrite(plan.num_to_write);
+            write_count_ += static_cast<std::uint64_t>(plan.num_to_write);
+        }
+
+        /**
+         * put the ready samples of a BroadcastReaderGroup into FIFOs, instead of calling process on the audio thread
+         * call it on the thread that owns the group, e.g. right before run, and do not call process elsewhere
+         * the samples skipped by overrun readers are marked, so that onset timestamps stay aligned
+         * @param group one reader per FFT
+         */
+        void pull(zldsp::container::BroadcastReaderGroup<FloatType, FFTNum> &group) {
+            std::array<std::span<FloatType *>, FFTNum> buffers;
+            while (true) {
+                const auto num_samples = group.read();
+                skip(static_cast<size_t>(group.popNumSkipped()));
+                if (num_samples == 0) return;
+                for (size_t i = 0; i < FFTNum; ++i) {
+                    buffers[i] = group.getBuffer(i);
                 }
+                process(buffers, num_samples);
             }
-            abstract_fifo_.finishWrite(free_space);
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @param x what process does when run falls behind,
+         * with kDecimate the FFT sees time-compressed samples, so the spectrum is shifted upwards and aliased
+         */
+        void setOverflowPolicy(const zldsp::container::OverflowPolicy x) { abstract_fifo_.setOverflowPolicy(x); }
+
+        /**
+         * thread-safe, lock-free
+         * @return the number of samples dropped by the FIFO
+         */
+        std::uint64_t getFIFODroppedCount() const { return abstract_fifo_.getDroppedCount(); }
+
+        /**
+         * thread-safe, lock-free
+         * @return the maximum number of samples waiting in the FIFO
+         */
+        int getFIFOHighWater() const { return abstract_fifo_.getHighWater(); }
+
+        void resetFIFOStats() { abstract_fifo_.resetStats(); }
+
+        /**
+         * mark samples that never reach process, e.g. the samples dropped by an overrun BroadcastRing reader
+         * so that onset timestamps stay aligned with the audio, only the thread that calls process may call this
+         * @param num_samples the number of samples missing before the next block passed to process
+         */
+        void skip(const size_t num_samples) {
+            if (num_samples == 0) return;
+            markDrop(write_count_, static_cast<std::uint64_t>(num_samples));
         }
 
         /**
@@ -124,11 +181,14 @@ namespace zldsp::analyzer {
             if (!is_prepared_.load(std::memory_order::acquire)) {
                 return;
             }
-            std::vector<size_t> is_on_vector{};
+            zldsp::container::FixedMaxSizeArray<size_t, FFTNum> is_on_vector{};
+            int num_ready{0};
             for (size_t i = 0; i < FFTNum; ++i) {
-                if (is_on_[i].load()) is_on_vector.push_back(i);
+                if (is_on_[i].load()) is_on_vector.push(i);
             } {
-                const int num_ready = abstract_fifo_.getNumReady();
+                // the discarded backlog has been written, so it stays part of the stream position
+                read_count_ += static_cast<std::uint64_t>(abstract_fifo_.applyResync());
+                num_ready = abstract_fifo_.getNumReady();
                 const auto range = abstract_fifo_.prepareToRead(num_ready);
                 const size_t num_replace = circular_buffers_[0].size() - static_cast<size_t>(num_ready);
                 for (const auto &i: is_on_vector) {
@@ -150,12 +210,52 @@ namespace zldsp::analyzer {
                     }
                 }
                 abstract_fifo_.finishRead(num_ready);
-            } {
+                read_count_ += static_cast<std::uint64_t>(num_ready);
+                applyDrops();
+            }
+            const auto timestamp = read_count_ + dropped_count_;
+            if (use_constant_q_.load(std::memory_order::relaxed)) {
+                if (to_update_cqt_.exchange(false, std::memory_order::acquire)) {
+                    prepareCQT();
+                } else if (to_reset_cqt_.exchange(false, std::memory_order::acquire)) {
+                    resetCQT();
+                } else {
+                    // the octave histories of the constant-Q transforms only need the new samples
+                    for (const auto &i: is_on_vector) {
+                        const auto &circular_buffer{circular_buffers_[i]};
+                        cqts_[i].process(circular_buffer.data() + circular_buffer.size() - static_cast<size_t>(num_ready),
+                                         static_cast<size_t>(num_ready));
+                    }
+                }
+                // the constant-Q outputs already sit on the interpolation grid
+                for (const auto &i: is_on_vector) {
+                    cqts_[i].forwardMagnitude(fft_buffer_);
+                    if (auto *detector = onset_detectors_[i].load(std::memory_order::acquire)) {
+                        detector->process(std::span<const float>(fft_buffer_.data(), PointNum), timestamp);
+                    }
+                    const auto decay = actual_decay_rate_[i].load();
+                    auto &smoothed_db{pre_interplot_dbs_[i]};
+                    if (to_reset_[i].exchange(false)) {
+                        std::fill(smoothed_db.begin(), smoothed_db.end(), kMinDB * 2.f);
+                    }
+                    for (size_t j = 0; j < PointNum; ++j) {
+                        const auto current_db = chore::gainToDecibels(fft_buffer_[j]);
+                        smoothed_db[j] = current_db < smoothed_db[j]
+                                             ? smoothed_db[j] * decay + current_db * (1 - decay)
+                                             : current_db;
+                    }
+                }
+            } else {
                 for (const auto &i: is_on_vector) {
                     std::copy(circular_buffers_[i].begin(), circular_buffers_[i].end(), fft_buffer_.begin());
-                    auto temp = kfr::make_univector(fft_buffer_.data(), window_.size());
-                    temp = temp * window_;
+                    const auto &window{window_->getData()};
+                    auto temp = kfr::make_univector(fft_buffer_.data(), window.size());
+                    temp = temp * window * window_scale_;
                     fft_.forwardMagnitudeOnly(fft_buffer_.data());
+                    if (auto *detector = onset_detectors_[i].load(std::memory_order::acquire)) {
+                        detector->process(std::span<const float>(fft_buffer_.data(), fft_.getSize() / 2 + 1),
+                                          timestamp);
+                    }
                     const auto decay = actual_decay_rate_[i].load();
                     auto &smoothed_db{smoothed_dbs_[i]};
                     if (to_reset_[i].exchange(false)) {
@@ -168,17 +268,21 @@ namespace zldsp::analyzer {
                                              : current_db;
                     }
 
-                    for (size_t j = 0; j < seq_input_dbs_.size(); ++j) {
+                    for (size_t j = 0; j < seq_input_freqs_.size(); ++j) {
                         const auto startIdx = seq_input_starts_[j];
                         const auto endIdx = seq_input_ends_[j];
-                        seq_input_dbs_[j] = std::reduce(
-                                                smoothed_db.begin() + startIdx,
-                                                smoothed_db.begin() + endIdx) / static_cast<float>(endIdx - startIdx);
+                        seq_akima_->setY(i, j, std::reduce(
+                                             smoothed_db.begin() + startIdx,
+                                             smoothed_db.begin() + endIdx) / static_cast<float>(endIdx - startIdx));
                     }
-
-                    seq_akima_->prepare();
-                    seq_akima_->eval(interplot_freqs_.data(), pre_interplot_dbs_[i].data(), PointNum);
                 }
+                // interpolate all spectrums in one pass
+                std::array<float *, FFTNum> pre_interplot_pointers{};
+                for (size_t i = 0; i < FFTNum; ++i) {
+                    pre_interplot_pointers[i] = pre_interplot_dbs_[i].data();
+                }
+                seq_akima_->prepare();
+                seq_akima_->eval(interplot_freqs_.data(), pre_interplot_pointers, PointNum);
             }
             if (to_update_tilt_.exchange(false, std::memory_order::acquire)) {
                 const float total_tilt = tilt_slope_.load() + extra_tilt_.load();
@@ -191,9 +295,10 @@ namespace zldsp::analyzer {
                 }
             } {
                 for (const auto &i: is_on_vector) {
+                    auto v0 = kfr::make_univector(pre_interplot_dbs_[i]);
                     auto v1 = kfr::make_univector(interplot_dbs_[i]);
-                    auto v2 =  kfr::make_univector(tilt_shift_);
-                    v1 = v1 + v2;
+                    auto v2 = kfr::make_univector(tilt_shift_);
+                    v1 = v0 + v2;
                 }
             }
         }
@@ -229,6 +334,31 @@ namespace zldsp::analyzer {
             updateActualDecayRate();
         }
 
+        /**
+         * attach an onset detector to the idx-th FFT, which receives every magnitude frame in run
+         * the detector is not owned, detach it (nullptr) before destroying it while run may be called
+         * @param idx
+         * @param detector
+         */
+        void setOnsetDetector(const size_t idx, OnsetDetector *detector) {
+            onset_detectors_[idx].store(detector, std::memory_order::release);
+        }
+
+        /**
+         * switch between the constant-Q transform and the interpolated FFT bins
+         * the constant-Q transform evaluates each output point directly with a window of constant Q,
+         * which avoids averaging wide FFT bins at the high end,
+         * the low end uses decimated octaves whose histories reach beyond the FFT size
+         * the kernels are built on the run thread when it is enabled for the first time after prepare,
+         * and the octave histories restart from the latest FFT frame whenever it is enabled
+         * @param x
+         */
+        void setConstantQ(const bool x) {
+            use_constant_q_.store(x, std::memory_order::relaxed);
+            to_reset_cqt_.store(true, std::memory_order::release);
+            reset();
+        }
+
     protected:
         size_t default_fft_order_ = 12;
         size_t bin_size_ = (1 << (default_fft_order_ - 1)) + 1;
@@ -245,9 +375,8 @@ namespace zldsp::analyzer {
         std::vector<float> seq_input_freqs_{};
         std::vector<std::vector<float>::difference_type> seq_input_starts_, seq_input_ends_;
         std::vector<size_t> seq_input_indices_;
-        std::vector<float> seq_input_dbs_{};
 
-        std::unique_ptr<zldsp::interpolation::SeqMakima<float> > seq_akima_;
+        std::unique_ptr<zldsp::interpolation::SeqMakimaBatch<float, FFTNum> > seq_akima_;
 
         std::array<float, PointNum> interplot_freqs_{};
         std::array<std::array<float, PointNum>, FFTNum> pre_interplot_dbs_{};
@@ -261,9 +390,38 @@ namespace zldsp::analyzer {
         std::atomic<bool> to_update_tilt_{true};
 
         zldsp::fft::KFREngine<float> fft_;
-        kfr::univector<float> window_;
+        // shared between instances, the 1 / N scale is applied in the windowing expression
+        std::shared_ptr<const zldsp::fft::Window<float> > window_;
+        float window_scale_{1.f};
+
+        // the constant-Q transforms keep octave histories, so each FFT has its own
+        std::array<zldsp::fft::ConstantQTransform<float>, FFTNum> cqts_;
+        std::atomic<bool> use_constant_q_{false};
+        size_t cqt_order_{12};
+        std::atomic<bool> to_update_cqt_{true}, to_reset_cqt_{true};
+
+        std::array<std::atomic<OnsetDetector *>, FFTNum> onset_detectors_{};
+        // the samples dropped before reaching the FIFO are marked at their position in the written stream,
+        // and only counted when run has read past that position
+        struct DropMark {
+            // the number of samples written to the FIFO before the dropped samples
+            std::uint64_t position;
+            std::uint64_t num;
+        };
+
+        static constexpr size_t kDropMarkCapacity = 64;
+        std::array<DropMark, kDropMarkCapacity> drop_marks_{};
+        zldsp::container::AbstractFIFO drop_mark_fifo_{static_cast<int>(kDropMarkCapacity)};
+        // the mark which does not fit into drop_mark_fifo_, accessed by the producer only
+        DropMark pending_mark_{0, 0};
+        // the number of samples written to the FIFO, accessed by the producer only
+        std::uint64_t write_count_{0};
+        // the number of samples read from / discarded by the FIFO and the number of dropped samples before them,
+        // i.e. the position of the newest sample, accessed by run only
+        std::uint64_t read_count_{0}, dropped_count_{0};
 
         std::atomic<float> sample_rate_{48000.f};
+        chore::CycleCounter process_counter_;
         std::array<std::atomic<bool>, FFTNum> to_reset_;
         std::atomic<bool> is_prepared_{false};
 
@@ -300,18 +458,16 @@ namespace zldsp::analyzer {
             seq_input_ends_.push_back(static_cast<std::vector<float>::difference_type>(bin_size_) - 1);
 
             seq_input_freqs_.resize(seq_input_indices.size());
-            seq_input_dbs_.resize(seq_input_indices.size());
-            seq_akima_ = std::make_unique<zldsp::interpolation::SeqMakima<float> >(
-                seq_input_freqs_.data(), seq_input_dbs_.data(), seq_input_freqs_.size(), 0.f, 0.f);
+            seq_akima_ = std::make_unique<zldsp::interpolation::SeqMakimaBatch<float, FFTNum> >(
+                seq_input_freqs_.data(), seq_input_freqs_.size(), 0.f, 0.f);
         }
 
         void setOrder(const int fft_order) {
             fft_.setOrder(static_cast<size_t>(fft_order));
 
-            window_.resize(static_cast<size_t>(fft_.getSize()));
-            zldsp::fft::fillCycleHanningWindow(window_, static_cast<size_t>(fft_.getSize()));
-            const auto scale = 1.f / static_cast<float>(fft_.getSize());
-            window_ = window_ * scale;
+            window_ = zldsp::fft::WindowCache<float>::getInstance().get(
+                zldsp::fft::WindowType::kHann, fft_.getSize(), true);
+            window_scale_ = 1.f / static_cast<float>(fft_.getSize());
 
             delta_t_.store(sample_rate_.load() / static_cast<float>(fft_.getSize()));
             decay_rate_.store(0.95f);
@@ -325,15 +481,81 @@ namespace zldsp::analyzer {
                 std::fill(smoothed_dbs_[i].begin(), smoothed_dbs_[i].end(), kMinDB * 2.f);
             }
 
+            // the constant-Q kernels are built on the run thread once constant-Q is enabled
+            cqt_order_ = static_cast<size_t>(fft_order);
+            to_update_cqt_.store(true, std::memory_order::release);
+
             const auto tempSize = fft_.getSize();
-            fft_buffer_.resize(tempSize * 2);
+            fft_buffer_.resize(std::max(tempSize * 2, PointNum));
             abstract_fifo_.setCapacity(static_cast<int>(tempSize));
+            // the FIFO is empty again, so the pending marks are counted right away
+            applyDropsOnPrepare();
             for (size_t i = 0; i < FFTNum; ++i) {
                 sample_fifos_[i].resize(tempSize);
                 circular_buffers_[i].resize(tempSize);
             }
         }
 
+        void prepareCQT() {
+            // Q of the output grid, so that neighbouring windows overlap at their -6 dB points
+            const auto grid_ratio = std::pow(2.f, (kMaxFreqLog2 - kMinFreqLog2) / static_cast<float>(PointNum - 1));
+            for (auto &cqt: cqts_) {
+                cqt.prepare(cqt_order_, static_cast<double>(sample_rate_.load()),
+                            std::span<const float>(interplot_freqs_), 2.0 / static_cast<double>(grid_ratio - 1.f));
+            }
+            resetCQT();
+        }
+
+        void resetCQT() {
+            to_reset_cqt_.store(false, std::memory_order::relaxed);
+            // the octave histories restart from the latest FFT frame
+            for (size_t i = 0; i < FFTNum; ++i) {
+                cqts_[i].reset();
+                cqts_[i].process(circular_buffers_[i].data(), circular_buffers_[i].size());
+            }
+        }
+
+        void markDrop(const std::uint64_t position, const std::uint64_t num) {
+            if (pending_mark_.num > 0) {
+                // merge into the mark which is still waiting, so that the samples are not lost
+                pending_mark_.num += num;
+            } else {
+                pending_mark_ = {position, num};
+            }
+            flushDropMark();
+        }
+
+        void flushDropMark() {
+            if (pending_mark_.num == 0 || drop_mark_fifo_.getNumFree() < 1) return;
+            const auto range = drop_mark_fifo_.prepareToWrite(1);
+            drop_marks_[static_cast<size_t>(range.start_index1)] = pending_mark_;
+            drop_mark_fifo_.finishWrite(1);
+            pending_mark_ = {0, 0};
+        }
+
+        void applyDropsOnPrepare() {
+            while (drop_mark_fifo_.getNumReady() > 0) {
+                const auto range = drop_mark_fifo_.prepareToRead(1);
+                dropped_count_ += drop_marks_[static_cast<size_t>(range.start_index1)].num;
+                drop_mark_fifo_.finishRead(1);
+            }
+            dropped_count_ += pending_mark_.num;
+            pending_mark_ = {0, 0};
+            // the samples left in the FIFO are skipped
+            read_count_ = write_count_;
+        }
+
+        void applyDrops() {
+            // a mark applies once the newest sample read comes after it
+            while (drop_mark_fifo_.getNumReady() > 0) {
+                const auto range = drop_mark_fifo_.prepareToRead(1);
+                const auto &mark{drop_marks_[static_cast<size_t>(range.start_index1)]};
+                if (mark.position >= read_count_) break;
+                dropped_count_ += mark.num;
+                drop_mark_fifo_.finishRead(1);
+            }
+        }
+
         void updateActualDecayRate() {
             for (size_t i = 0; i < FFTNum; ++i) {
                 const auto x = 1 - (1 - decay_rates_[i].load(std::memory_order::relaxed)
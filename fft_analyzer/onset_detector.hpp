@@ -0,0 +1,195 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../container/abstract_fifo.hpp"
+#include "../vector/kfr_import.hpp"
+
+namespace zldsp::analyzer {
+    struct OnsetEvent {
+        // the sample position of the newest sample in the onset frame
+        std::uint64_t timestamp;
+        // the novelty above the adaptive threshold
+        float strength;
+    };
+
+    /**
+     * an onset detector which works on consecutive magnitude frames, e.g. from MultipleFFTBase
+     * the novelty function is either the log-compressed spectral flux or the rise of the high-frequency content
+     * a peak is picked if it is a local maximum above an adaptive threshold (median of recent novelties),
+     * and no other onset has been picked within the minimum interval
+     * events are exported through a lock-free single-producer single-consumer FIFO
+     */
+    class OnsetDetector {
+    public:
+        enum NoveltyType {
+            kSpectralFlux, kHFC
+        };
+
+        static constexpr size_t kMedianSize = 16;
+        static constexpr size_t kEventCapacity = 64;
+
+        OnsetDetector() = default;
+
+        void reset() {
+            std::fill(pre_log_mags_.begin(), pre_log_mags_.end(), 0.f);
+            std::fill(novelties_.begin(), novelties_.end(), 0.f);
+            novelty_pos_ = 0;
+            pre_hfc_ = 0.f;
+            pre_novelty_ = 0.f;
+            pre_pre_novelty_ = 0.f;
+            pre_timestamp_ = 0;
+            last_onset_ = 0;
+            has_onset_ = false;
+            is_first_frame_ = true;
+        }
+
+        /**
+         * feed a magnitude frame, call from the analyzer thread
+         * the frame size may change between calls (e.g. after the FFT order changes), which resets the detector
+         * @param mags the magnitudes of bins [0, N/2]
+         * @param timestamp the sample position of the newest sample in the frame
+         */
+        void process(std::span<const float> mags, const std::uint64_t timestamp) {
+            if (mags.size() != pre_log_mags_.size()) {
+                pre_log_mags_.resize(mags.size());
+                log_mags_.resize(mags.size());
+                bin_indices_.resize(mags.size());
+                for (size_t j = 0; j < bin_indices_.size(); ++j) {
+                    bin_indices_[j] = static_cast<float>(j);
+                }
+                reset();
+            }
+            const auto compression = compression_.load(std::memory_order::relaxed);
+            const auto mag_vector = kfr::make_univector(mags.data(), mags.size());
+            float novelty{0.f};
+            if (novelty_type_.load(std::memory_order::relaxed) == kSpectralFlux) {
+                // half-wave rectified difference of log(1 + gamma * |X|)
+                log_mags_ = kfr::log(mag_vector * compression + 1.f);
+                novelty = kfr::sum(kfr::max(log_mags_ - pre_log_mags_, 0.f)) / static_cast<float>(mags.size());
+                pre_log_mags_ = log_mags_;
+            } else {
+                // sum of k * |X_k|^2, the novelty is the relative rise
+                const auto hfc_sum = kfr::dotproduct(bin_indices_, mag_vector * mag_vector);
+                const auto hfc = std::log1p(compression * hfc_sum / static_cast<float>(mags.size()));
+                novelty = std::max(hfc - pre_hfc_, 0.f);
+                pre_hfc_ = hfc;
+            }
+            if (is_first_frame_) {
+                // the first frame has nothing to compare with
+                is_first_frame_ = false;
+                novelty = 0.f;
+            }
+            // the previous novelty is a peak if it is a local maximum above the adaptive threshold
+            const auto threshold = getMedian() * threshold_scale_.load(std::memory_order::relaxed)
+                                   + threshold_offset_.load(std::memory_order::relaxed);
+            if (pre_novelty_ > pre_pre_novelty_ && pre_novelty_ >= novelty && pre_novelty_ > threshold) {
+                const auto min_interval = min_interval_.load(std::memory_order::relaxed);
+                if (!has_onset_ || pre_timestamp_ >= last_onset_ + min_interval) {
+                    pushEvent({pre_timestamp_, pre_novelty_ - threshold});
+                    last_onset_ = pre_timestamp_;
+                    has_onset_ = true;
+                }
+            }
+            novelties_[novelty_pos_] = novelty;
+            novelty_pos_ = (novelty_pos_ + 1) % kMedianSize;
+            pre_pre_novelty_ = pre_novelty_;
+            pre_novelty_ = novelty;
+            pre_timestamp_ = timestamp;
+        }
+
+        /**
+         * pop the pending events, call from a single consumer thread (e.g. the audio thread)
+         * @param events
+         * @return the number of events written
+         */
+        size_t popEvents(std::span<OnsetEvent> events) {
+            const auto num_ready = std::min(fifo_.getNumReady(), static_cast<int>(events.size()));
+            if (num_ready <= 0) return 0;
+            const auto range = fifo_.prepareToRead(num_ready);
+            size_t k = 0;
+            for (int i = 0; i < range.block_size1; ++i) {
+                events[k++] = events_[static_cast<size_t>(range.start_index1 + i)];
+            }
+            for (int i = 0; i < range.block_size2; ++i) {
+                events[k++] = events_[static_cast<size_t>(range.start_index2 + i)];
+            }
+            fifo_.finishRead(num_ready);
+            return k;
+        }
+
+        void setNoveltyType(const NoveltyType x) {
+            novelty_type_.store(x, std::memory_order::relaxed);
+        }
+
+        /**
+         * @param x the gamma of the log compression
+         */
+        void setCompression(const float x) {
+            compression_.store(std::max(x, 0.f), std::memory_order::relaxed);
+        }
+
+        /**
+         * threshold = median of the last novelties * scale + offset
+         * @param scale
+         * @param offset
+         */
+        void setThreshold(const float scale, const float offset) {
+            threshold_scale_.store(scale, std::memory_order::relaxed);
+            threshold_offset_.store(offset, std::memory_order::relaxed);
+        }
+
+        /**
+         * @param x the minimum number of samples between two onsets
+         */
+        void setMinInterval(const std::uint64_t x) {
+            min_interval_.store(x, std::memory_order::relaxed);
+        }
+
+    private:
+        kfr::univector<float> pre_log_mags_, log_mags_, bin_indices_;
+        float pre_hfc_{0.f};
+        std::array<float, kMedianSize> novelties_{}, median_buffer_{};
+        size_t novelty_pos_{0};
+        float pre_novelty_{0.f}, pre_pre_novelty_{0.f};
+        std::uint64_t pre_timestamp_{0}, last_onset_{0};
+        bool has_onset_{false}, is_first_frame_{true};
+
+        std::atomic<NoveltyType> novelty_type_{kSpectralFlux};
+        std::atomic<float> compression_{100.f}, threshold_scale_{1.5f}, threshold_offset_{0.01f};
+        std::atomic<std::uint64_t> min_interval_{2048};
+
+        std::array<OnsetEvent, kEventCapacity> events_{};
+        zldsp::container::AbstractFIFO fifo_{static_cast<int>(kEventCapacity)};
+
+        float getMedian() {
+            median_buffer_ = novelties_;
+            const auto mid = median_buffer_.begin() + kMedianSize / 2;
+            std::nth_element(median_buffer_.begin(), mid, median_buffer_.end());
+            return *mid;
+        }
+
+        void pushEvent(const OnsetEvent event) {
+            // drop the event if the consumer falls behind
+            if (fifo_.getNumFree() < 1) return;
+            const auto range = fifo_.prepareToWrite(1);
+            events_[static_cast<size_t>(range.start_index1)] = event;
+            fifo_.finishWrite(1);
+        }
+    };
+}
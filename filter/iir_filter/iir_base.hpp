@@ -14,6 +14,9 @@
 #include <complex>
 #include <span>
 
+#include "../../chore/realtime_check.hpp"
+#include "../../chore/cycle_counter.hpp"
+
 namespace zldsp::filter {
     template<typename FloatType>
     class IIRBase {
@@ -43,6 +46,7 @@ namespace zldsp::filter {
         IIRBase() = default;
 
         void prepare(const size_t num_channels) {
+            process_counter_.prepare("zldsp::filter::IIRBase::process", this);
             s1_.resize(num_channels);
             s2_.resize(num_channels);
             reset();
@@ -55,6 +59,8 @@ namespace zldsp::filter {
 
         template <bool isBypass = false>
         void process(std::span<FloatType*> buffer, const size_t num_samples) noexcept {
+            ZLDSP_REALTIME_SCOPE("zldsp::filter::IIRBase::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
             for (size_t channel = 0; channel < buffer.size(); ++channel) {
                 auto *samples = buffer[channel];
                 for (size_t i = 0; i < num_samples; ++i) {
@@ -67,6 +73,17 @@ namespace zldsp::filter {
             }
         }
 
+        /**
+         * process one frame of an interleaved buffer, the channel loop runs over contiguous samples and states
+         * @param frame
+         * @param num_channels
+         */
+        void processFrame(FloatType *frame, const size_t num_channels) noexcept {
+            for (size_t channel = 0; channel < num_channels; ++channel) {
+                frame[channel] = processSample(channel, frame[channel]);
+            }
+        }
+
         FloatType processSample(const size_t channel, FloatType inputValue) {
             const auto outputValue = inputValue * coeff_[0] + s1_[channel];
             s1_[channel] = (inputValue * coeff_[1]) - (outputValue * coeff_[3]) + s2_[channel];
@@ -86,5 +103,6 @@ namespace zldsp::filter {
     private:
         std::array<FloatType, 5> coeff_{0, 0, 0, 0, 0};
         std::vector<FloatType> s1_, s2_;
+        chore::CycleCounter process_counter_;
     };
 }
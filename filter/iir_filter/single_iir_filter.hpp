@@ -14,6 +14,8 @@
 
 #include "../filter_design/filter_design.hpp"
 #include "../../chore/smoothed_value.hpp"
+#include "../../chore/realtime_check.hpp"
+#include "../../chore/cycle_counter.hpp"
 #include "coeff/martin_coeff.hpp"
 #include "iir_base.hpp"
 
@@ -35,6 +37,8 @@ namespace zldsp::filter {
         }
 
         void prepare(const double sample_rate, const size_t num_channels) {
+            process_counter_.prepare("zldsp::filter::IIR::process", this);
+            interleaved_counter_.prepare("zldsp::filter::IIR::processInterleaved", this);
             for (auto &f: filters_) {
                 f.prepare(num_channels);
             }
@@ -49,6 +53,7 @@ namespace zldsp::filter {
          * prepare for processing the incoming audio buffer
          */
         void prepareBuffer() {
+            ZLDSP_REALTIME_SCOPE("zldsp::filter::IIR::prepareBuffer");
             if (to_update_para_.exchange(false, std::memory_order::acquire)) {
                 c_filter_type_ = filter_type_.load(std::memory_order::relaxed);
                 c_order_ = order_.load(std::memory_order::relaxed);
@@ -69,7 +74,9 @@ namespace zldsp::filter {
          */
         template<bool IsBypassed = false>
         void process(std::span<FloatType *> buffer, const size_t num_samples) {
-            if (c_freq_.isSmoothing() || c_gain_.isSmoothing() || c_q_.isSmoothing()) {
+            ZLDSP_REALTIME_SCOPE("zldsp::filter::IIR::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            if (isSmoothing()) {
                 processIIR<IsBypassed, true>(buffer, num_samples);
             } else {
                 processIIR<IsBypassed, false>(buffer, num_samples);
@@ -92,6 +99,68 @@ namespace zldsp::filter {
             }
         }
 
+        /**
+         * process an interleaved buffer in place
+         * @param buffer num_samples frames of num_channels samples
+         * @param num_channels at most the number of channels given to prepare
+         * @param num_samples the number of frames
+         */
+        template<bool IsBypassed = false>
+        void processInterleaved(FloatType *buffer, const size_t num_channels, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::filter::IIR::processInterleaved");
+            ZLDSP_CYCLE_COUNTER(interleaved_counter_, num_samples);
+            if (isSmoothing()) {
+                processIIRInterleaved<IsBypassed, true>(buffer, num_channels, num_samples);
+            } else {
+                processIIRInterleaved<IsBypassed, false>(buffer, num_channels, num_samples);
+            }
+        }
+
+        template<bool IsBypassed = false, bool IsSmooth = false>
+        void processIIRInterleaved(FloatType *buffer, const size_t num_channels, const size_t num_samples) {
+            for (size_t i = 0; i < num_samples; ++i) {
+                if (IsSmooth) updateCoeffs();
+                auto *frame = buffer + i * num_channels;
+                if (IsBypassed) {
+                    for (size_t channel = 0; channel < num_channels; ++channel) {
+                        auto sample = frame[channel];
+                        for (size_t filter_idx = 0; filter_idx < current_filter_num_; ++filter_idx) {
+                            sample = filters_[filter_idx].processSample(channel, sample);
+                        }
+                    }
+                } else {
+                    // each section runs across all channels of the frame
+                    for (size_t filter_idx = 0; filter_idx < current_filter_num_; ++filter_idx) {
+                        filters_[filter_idx].processFrame(frame, num_channels);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @return whether frequency, gain or Q is smoothing
+         * if so, processSample<true> should be used for the current buffer
+         */
+        [[nodiscard]] bool isSmoothing() const {
+            return c_freq_.isSmoothing() || c_gain_.isSmoothing() || c_q_.isSmoothing();
+        }
+
+        /**
+         * process one sample through the cascade, for fusing the filter into other per-sample loops
+         * with IsSmooth, the coefficients are updated on every call, so use it on a single channel only
+         * @param channel
+         * @param sample
+         * @return
+         */
+        template<bool IsSmooth = false>
+        FloatType processSample(const size_t channel, FloatType sample) {
+            if (IsSmooth) updateCoeffs();
+            for (size_t filter_idx = 0; filter_idx < current_filter_num_; ++filter_idx) {
+                sample = filters_[filter_idx].processSample(channel, sample);
+            }
+            return sample;
+        }
+
         /**
          * set the frequency of the filter
          * @param freq
@@ -253,6 +322,7 @@ namespace zldsp::filter {
 
         std::atomic<bool> to_update_para_{true};
         std::atomic<bool> to_update_fgq_{false};
+        chore::CycleCounter process_counter_, interleaved_counter_;
 
         std::array<std::array<double, 6>, FilterSize> coeffs_{};
 
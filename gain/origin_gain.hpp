@@ -9,16 +9,22 @@
 
 #pragma once
 
+#include <algorithm>
 #include <span>
 
 #include "../chore/smoothed_value.hpp"
 #include "../chore/decibels.hpp"
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
 #include "../vector/vector.hpp"
 
 namespace zldsp::gain {
     template<typename FloatType>
     class Gain {
     public:
+        // the maximum length of the ramp buffer, any block size is accepted
+        static constexpr size_t kSubBlockSize = 1024;
+
         Gain() noexcept = default;
 
         void reset() {
@@ -47,32 +53,85 @@ namespace zldsp::gain {
 
         [[nodiscard]] bool isSmoothing() const noexcept { return gain_.isSmoothing(); }
 
+        /**
+         * @param sample_rate
+         * @param max_num_samples the ramp buffer holds at most kSubBlockSize samples, larger blocks are processed
+         * in sub-blocks
+         * @param ramp_length_in_seconds
+         */
         void prepare(const double sample_rate, const size_t max_num_samples,
                      const double ramp_length_in_seconds) noexcept {
+            process_counter_.prepare("zldsp::gain::Gain::process", this);
+            interleaved_counter_.prepare("zldsp::gain::Gain::processInterleaved", this);
             gain_.prepare(sample_rate, ramp_length_in_seconds);
-            gain_vs_.resize(max_num_samples);
+            gain_vs_.resize(std::clamp(max_num_samples, static_cast<size_t>(1), kSubBlockSize));
         }
 
         template<bool IsBypassed = false>
         void process(std::span<FloatType *> buffer, const size_t num_samples) {
-            if (!gain_.isSmoothing()) {
-                if (IsBypassed) return;
-                for (size_t chan = 0; chan < buffer.size(); ++chan) {
-                    zldsp::vector::multiply(buffer[chan], gain_.getCurrent(), num_samples);
+            ZLDSP_REALTIME_SCOPE("zldsp::gain::Gain::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            size_t start = 0;
+            while (start < num_samples) {
+                if (!gain_.isSmoothing()) {
+                    if (IsBypassed) return;
+                    for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                        zldsp::vector::multiply(buffer[chan] + start, gain_.getCurrent(), num_samples - start);
+                    }
+                    return;
+                }
+                const auto num = std::min(num_samples - start, gain_vs_.size());
+                for (size_t idx = 0; idx < num; ++idx) {
+                    gain_vs_[idx] = gain_.getNext();
+                }
+                if (!IsBypassed) {
+                    for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                        zldsp::vector::multiply(buffer[chan] + start, gain_vs_.data(), num);
+                    }
+                }
+                start += num;
+            }
+        }
+
+        /**
+         * process an interleaved buffer in place
+         * @param buffer num_samples frames of num_channels samples
+         * @param num_channels
+         * @param num_samples the number of frames
+         */
+        template<bool IsBypassed = false>
+        void processInterleaved(FloatType *buffer, const size_t num_channels, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::gain::Gain::processInterleaved");
+            ZLDSP_CYCLE_COUNTER(interleaved_counter_, num_samples);
+            size_t start = 0;
+            while (start < num_samples) {
+                if (!gain_.isSmoothing()) {
+                    if (IsBypassed) return;
+                    // a constant gain does not care about the layout
+                    zldsp::vector::multiply(buffer + start * num_channels, gain_.getCurrent(),
+                                            (num_samples - start) * num_channels);
+                    return;
                 }
-            } else {
-                for (size_t idx = 0; idx < num_samples; ++idx) {
+                const auto num = std::min(num_samples - start, gain_vs_.size());
+                for (size_t idx = 0; idx < num; ++idx) {
                     gain_vs_[idx] = gain_.getNext();
                 }
-                if (IsBypassed) return;
-                for (size_t chan = 0; chan < buffer.size(); ++chan) {
-                    zldsp::vector::multiply(buffer[chan], gain_vs_.data(), num_samples);
+                if (!IsBypassed) {
+                    for (size_t idx = 0; idx < num; ++idx) {
+                        auto *frame = buffer + (start + idx) * num_channels;
+                        const auto g = gain_vs_[idx];
+                        for (size_t chan = 0; chan < num_channels; ++chan) {
+                            frame[chan] *= g;
+                        }
+                    }
                 }
+                start += num;
             }
         }
 
     private:
         zldsp::chore::SmoothedValue<FloatType, zldsp::chore::SmoothedTypes::kFixLin> gain_{FloatType(1)};
         kfr::univector<FloatType> gain_vs_;
+        chore::CycleCounter process_counter_, interleaved_counter_;
     };
 }
@@ -47,20 +47,35 @@ namespace zldsp::gain {
 
         void prepare(const double sample_rate, const size_t max_num_samples,
                      const double ramp_length_in_seconds) noexcept {
+            process_counter_.prepare("zldsp::gain::SafeGain::process", this);
+            interleaved_counter_.prepare("zldsp::gain::SafeGain::processInterleaved", this);
             gain_.prepare(sample_rate, max_num_samples, ramp_length_in_seconds);
         }
 
         template<bool IsBypassed = false>
         void process(std::span<FloatType *> buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::gain::SafeGain::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
             if (to_update_.exchange(false, std::memory_order::acquire)) {
                 gain_.setGainLinear(gain_v_.load(std::memory_order::relaxed));
             }
             gain_.template process<IsBypassed>(buffer, num_samples);
         }
 
+        template<bool IsBypassed = false>
+        void processInterleaved(FloatType *buffer, const size_t num_channels, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::gain::SafeGain::processInterleaved");
+            ZLDSP_CYCLE_COUNTER(interleaved_counter_, num_samples);
+            if (to_update_.exchange(false, std::memory_order::acquire)) {
+                gain_.setGainLinear(gain_v_.load(std::memory_order::relaxed));
+            }
+            gain_.template processInterleaved<IsBypassed>(buffer, num_channels, num_samples);
+        }
+
     private:
         Gain<FloatType> gain_;
         std::atomic<FloatType> gain_v_{FloatType(1)};
         std::atomic<bool> to_update_{false};
+        chore::CycleCounter process_counter_, interleaved_counter_;
     };
 }
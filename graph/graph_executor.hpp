@@ -0,0 +1,335 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "node_base.hpp"
+#include "work_stealing_deque.hpp"
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
+
+namespace zldsp::graph {
+    inline void cpuRelax() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    /**
+     * a DAG executor which runs independent branches on a fixed pool of worker threads
+     * each node owns a buffer, the input of a node is the sum of the outputs of its predecessors
+     * the calling thread participates in the work, the workers steal ready nodes from each other
+     * the graph must be built and prepared on the message thread while process is not running
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class GraphExecutor {
+    public:
+        static constexpr size_t kSpinNum = 4096;
+
+        GraphExecutor() = default;
+
+        ~GraphExecutor() {
+            stopWorkers();
+        }
+
+        GraphExecutor(const GraphExecutor &) = delete;
+
+        GraphExecutor &operator=(const GraphExecutor &) = delete;
+
+        /**
+         * add a node, the node is not owned by the executor
+         * @param node
+         * @param num_channels the number of channels of the node buffer
+         * @return the index of the node
+         */
+        size_t addNode(NodeBase<FloatType> &node, const size_t num_channels) {
+            nodes_.emplace_back();
+            nodes_.back().node = &node;
+            nodes_.back().num_channels = num_channels;
+            return nodes_.size() - 1;
+        }
+
+        /**
+         * add an edge, the output of node from is summed into the input of node to
+         * if the channel numbers differ, only the common channels are summed
+         * @param from
+         * @param to
+         */
+        void addEdge(const size_t from, const size_t to) {
+            nodes_[from].successors.emplace_back(to);
+            nodes_[to].predecessors.emplace_back(from);
+        }
+
+        /**
+         * remove all nodes and edges, stop the workers
+         */
+        void clear() {
+            stopWorkers();
+            nodes_.clear();
+            order_.clear();
+        }
+
+        /**
+         * allocate the buffers and start the workers
+         * @param max_num_samples
+         * @param num_workers the number of worker threads besides the calling thread, 0 runs the graph serially
+         * @return false if the graph contains a cycle
+         */
+        bool prepare(const size_t max_num_samples, const size_t num_workers) {
+            stopWorkers();
+            process_counter_.prepare("zldsp::graph::GraphExecutor::process", this);
+            if (!sortNodes()) {
+                return false;
+            }
+            max_num_samples_ = max_num_samples;
+            for (auto &n: nodes_) {
+                n.buffers.resize(n.num_channels);
+                n.pointers.resize(n.num_channels);
+                for (size_t chan = 0; chan < n.num_channels; ++chan) {
+                    n.buffers[chan].resize(max_num_samples);
+                    std::fill(n.buffers[chan].begin(), n.buffers[chan].end(), FloatType(0));
+                    n.pointers[chan] = n.buffers[chan].data();
+                }
+            }
+            pending_ = std::make_unique<std::atomic<int>[]>(nodes_.size());
+            deques_ = std::vector<WorkStealingDeque>(num_workers + 1);
+            for (auto &deque: deques_) {
+                deque.setCapacity(nodes_.size());
+            }
+            remaining_.store(0);
+            exit_.store(false);
+            workers_.reserve(num_workers);
+            for (size_t i = 0; i < num_workers; ++i) {
+                workers_.emplace_back([this, i]() { workerLoop(i + 1); });
+            }
+            return true;
+        }
+
+        /**
+         * the host fills the buffers of source nodes before process, and reads the buffers of sink nodes after process
+         * @param idx
+         * @return the buffer of the node
+         */
+        std::span<FloatType *> getNodeBuffer(const size_t idx) {
+            return {nodes_[idx].pointers};
+        }
+
+        /**
+         * run all nodes once, returns when every node has finished
+         * @param num_samples must not exceed max_num_samples, larger values are clamped in release builds
+         */
+        void process(const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::graph::GraphExecutor::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            if (nodes_.empty()) return;
+            assert(num_samples <= max_num_samples_ && "num_samples exceeds the max_num_samples passed to prepare");
+            num_samples_ = std::min(num_samples, max_num_samples_);
+            if (workers_.empty()) {
+                for (const auto idx: order_) {
+                    runNode(idx);
+                }
+                return;
+            }
+            for (size_t i = 0; i < nodes_.size(); ++i) {
+                pending_[i].store(static_cast<int>(nodes_[i].predecessors.size()), std::memory_order::relaxed);
+            }
+            remaining_.store(static_cast<int>(nodes_.size()), std::memory_order::release);
+            for (size_t i = 0; i < nodes_.size(); ++i) {
+                if (nodes_[i].predecessors.empty()) {
+                    deques_[0].push(static_cast<int>(i));
+                }
+            }
+            // wake up the workers, notify is cheap if no worker is waiting
+            epoch_.fetch_add(1, std::memory_order::seq_cst);
+            epoch_.notify_all();
+            join(0);
+        }
+
+        [[nodiscard]] size_t getNumNodes() const { return nodes_.size(); }
+
+        [[nodiscard]] size_t getNumWorkers() const { return workers_.size(); }
+
+    private:
+        struct Node {
+            NodeBase<FloatType> *node{nullptr};
+            size_t num_channels{0};
+            std::vector<size_t> predecessors, successors;
+            std::vector<std::vector<FloatType> > buffers;
+            std::vector<FloatType *> pointers;
+        };
+
+        std::vector<Node> nodes_;
+        std::vector<size_t> order_;
+        std::unique_ptr<std::atomic<int>[]> pending_;
+        std::vector<WorkStealingDeque> deques_;
+        std::vector<std::thread> workers_;
+        size_t num_samples_{0}, max_num_samples_{0};
+        chore::CycleCounter process_counter_;
+
+        alignas(64) std::atomic<int> remaining_{0};
+        alignas(64) std::atomic<std::uint32_t> epoch_{0};
+        std::atomic<bool> exit_{false};
+
+        /**
+         * Kahn's algorithm
+         * @return false if the graph contains a cycle
+         */
+        bool sortNodes() {
+            order_.clear();
+            order_.reserve(nodes_.size());
+            std::vector<size_t> in_degrees(nodes_.size());
+            for (size_t i = 0; i < nodes_.size(); ++i) {
+                in_degrees[i] = nodes_[i].predecessors.size();
+                if (in_degrees[i] == 0) {
+                    order_.emplace_back(i);
+                }
+            }
+            for (size_t k = 0; k < order_.size(); ++k) {
+                for (const auto s: nodes_[order_[k]].successors) {
+                    in_degrees[s] -= 1;
+                    if (in_degrees[s] == 0) {
+                        order_.emplace_back(s);
+                    }
+                }
+            }
+            return order_.size() == nodes_.size();
+        }
+
+        void stopWorkers() {
+            if (workers_.empty()) return;
+            exit_.store(true);
+            epoch_.fetch_add(1);
+            epoch_.notify_all();
+            for (auto &worker: workers_) {
+                worker.join();
+            }
+            workers_.clear();
+        }
+
+        /**
+         * sum the predecessors into the node buffer, then process the node
+         * @param idx
+         */
+        void runNode(const size_t idx) {
+            auto &n = nodes_[idx];
+            if (!n.predecessors.empty()) {
+                for (size_t chan = 0; chan < n.num_channels; ++chan) {
+                    std::fill(n.pointers[chan], n.pointers[chan] + num_samples_, FloatType(0));
+                }
+                for (const auto p: n.predecessors) {
+                    const auto &pre = nodes_[p];
+                    const auto num_channels = std::min(n.num_channels, pre.num_channels);
+                    for (size_t chan = 0; chan < num_channels; ++chan) {
+                        auto *out = n.pointers[chan];
+                        const auto *in = pre.pointers[chan];
+                        for (size_t i = 0; i < num_samples_; ++i) {
+                            out[i] += in[i];
+                        }
+                    }
+                }
+            }
+            n.node->process(std::span<FloatType *>(n.pointers), num_samples_);
+        }
+
+        /**
+         * run the node, then push the successors which become ready onto the deque of the current thread
+         * @param idx
+         * @param thread_idx
+         */
+        void runAndRelease(const size_t idx, const size_t thread_idx) {
+            runNode(idx);
+            for (const auto s: nodes_[idx].successors) {
+                if (pending_[s].fetch_sub(1, std::memory_order::acq_rel) == 1) {
+                    deques_[thread_idx].push(static_cast<int>(s));
+                }
+            }
+            remaining_.fetch_sub(1, std::memory_order::acq_rel);
+            // wake up the threads which wait for new ready nodes or for the end of the run
+            remaining_.notify_all();
+        }
+
+        /**
+         * pop from the own deque, otherwise steal from others
+         * @param thread_idx
+         * @return false if no node has been found after spinning
+         */
+        bool work(const size_t thread_idx) {
+            const auto num_deques = deques_.size();
+            size_t spin = 0;
+            while (remaining_.load(std::memory_order::acquire) > 0) {
+                auto x = deques_[thread_idx].pop();
+                for (size_t k = 1; x == WorkStealingDeque::kEmpty && k < num_deques; ++k) {
+                    x = deques_[(thread_idx + k) % num_deques].steal();
+                }
+                if (x != WorkStealingDeque::kEmpty) {
+                    runAndRelease(static_cast<size_t>(x), thread_idx);
+                    spin = 0;
+                } else if (spin < kSpinNum) {
+                    cpuRelax();
+                    spin += 1;
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * work until all nodes have finished, block until another node finishes if nothing can be stolen
+         * @param thread_idx
+         */
+        void join(const size_t thread_idx) {
+            while (!work(thread_idx)) {
+                const auto remaining = remaining_.load(std::memory_order::acquire);
+                if (remaining == 0) break;
+                remaining_.wait(remaining, std::memory_order::acquire);
+            }
+        }
+
+        void workerLoop(const size_t thread_idx) {
+            auto epoch = epoch_.load(std::memory_order::acquire);
+            while (true) {
+                // spin-then-wait for the next run
+                size_t spin = 0;
+                auto current_epoch = epoch_.load(std::memory_order::acquire);
+                while (current_epoch == epoch) {
+                    if (spin < kSpinNum) {
+                        cpuRelax();
+                        spin += 1;
+                    } else {
+                        epoch_.wait(epoch, std::memory_order::acquire);
+                    }
+                    current_epoch = epoch_.load(std::memory_order::acquire);
+                }
+                epoch = current_epoch;
+                if (exit_.load(std::memory_order::acquire)) return;
+                ZLDSP_REALTIME_SCOPE("zldsp::graph::GraphExecutor::join");
+                join(thread_idx);
+            }
+        }
+    };
+}
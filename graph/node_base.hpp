@@ -0,0 +1,30 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <span>
+
+namespace zldsp::graph {
+    template<typename FloatType>
+    class NodeBase {
+    public:
+        NodeBase() = default;
+
+        virtual ~NodeBase() = default;
+
+        /**
+         * process the node buffer in place
+         * it may be called from any worker thread, but never concurrently for the same node
+         * @param buffer
+         * @param num_samples
+         */
+        virtual void process(std::span<FloatType *> buffer, size_t num_samples) = 0;
+    };
+}
@@ -0,0 +1,105 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace zldsp::graph {
+    /**
+     * a fixed-capacity lock-free Chase-Lev work-stealing deque
+     * the owner pushes/pops at the bottom, other threads steal from the top
+     * indices grow monotonically, so the deque never needs to be reset between runs
+     */
+    class WorkStealingDeque {
+    public:
+        static constexpr int kEmpty = -1;
+
+        explicit WorkStealingDeque(const size_t capacity = 1) {
+            setCapacity(capacity);
+        }
+
+        /**
+         * call before any thread accesses the deque
+         * @param capacity the maximum number of elements at the same time
+         */
+        void setCapacity(const size_t capacity) {
+            const auto actual_capacity = std::bit_ceil(std::max(capacity, static_cast<size_t>(1)));
+            buffer_ = std::vector<std::atomic<int> >(actual_capacity);
+            mask_ = static_cast<std::int64_t>(actual_capacity) - 1;
+            top_.store(0);
+            bottom_.store(0);
+        }
+
+        /**
+         * owner only
+         * @param x
+         */
+        void push(const int x) {
+            const auto b = bottom_.load(std::memory_order::relaxed);
+            buffer_[static_cast<size_t>(b & mask_)].store(x, std::memory_order::relaxed);
+            std::atomic_thread_fence(std::memory_order::release);
+            bottom_.store(b + 1, std::memory_order::relaxed);
+        }
+
+        /**
+         * owner only
+         * @return the element at the bottom, kEmpty if the deque is empty
+         */
+        int pop() {
+            const auto b = bottom_.load(std::memory_order::relaxed) - 1;
+            bottom_.store(b, std::memory_order::relaxed);
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+            auto t = top_.load(std::memory_order::relaxed);
+            if (t > b) {
+                bottom_.store(b + 1, std::memory_order::relaxed);
+                return kEmpty;
+            }
+            auto x = buffer_[static_cast<size_t>(b & mask_)].load(std::memory_order::relaxed);
+            if (t == b) {
+                // the last element, race against thieves
+                if (!top_.compare_exchange_strong(t, t + 1,
+                                                  std::memory_order::seq_cst, std::memory_order::relaxed)) {
+                    x = kEmpty;
+                }
+                bottom_.store(b + 1, std::memory_order::relaxed);
+            }
+            return x;
+        }
+
+        /**
+         * any thread
+         * @return the element at the top, kEmpty if the deque is empty or the steal loses a race
+         */
+        int steal() {
+            auto t = top_.load(std::memory_order::acquire);
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+            const auto b = bottom_.load(std::memory_order::acquire);
+            if (t >= b) {
+                return kEmpty;
+            }
+            const auto x = buffer_[static_cast<size_t>(t & mask_)].load(std::memory_order::relaxed);
+            if (!top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order::seq_cst, std::memory_order::relaxed)) {
+                return kEmpty;
+            }
+            return x;
+        }
+
+    private:
+        std::vector<std::atomic<int> > buffer_;
+        std::int64_t mask_{0};
+        alignas(64) std::atomic<std::int64_t> top_{0};
+        alignas(64) std::atomic<std::int64_t> bottom_{0};
+    };
+}
@@ -10,3 +10,4 @@
 #pragma once
 
 #include "seq_makima.hpp"
+#include "seq_makima_batch.hpp"
@@ -0,0 +1,160 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cmath>
+
+namespace zldsp::interpolation {
+    /**
+     * modified Akima spline interpolation of multiple curves which share the same increasing input/output X
+     * the X-dependent work is done once for all curves, the Y-dependent work is vectorized across curves
+     * @tparam FloatType the float type of input/output
+     * @tparam CurveNum the number of curves
+     */
+    template<typename FloatType, size_t CurveNum>
+    class SeqMakimaBatch {
+    public:
+        using Values = std::array<FloatType, CurveNum>;
+
+        /**
+         *
+         * @param x input X pointer
+         * @param point_num number of input points
+         * @param left_derivative left derivative
+         * @param right_derivative right derivative
+         */
+        explicit SeqMakimaBatch(FloatType *x, const size_t point_num,
+                                FloatType left_derivative, FloatType right_derivative)
+            : xs_(x), input_size_(point_num),
+              left_derivative_(left_derivative), right_derivative_(right_derivative) {
+            ys_.resize(point_num);
+            derivatives_.resize(point_num);
+            deltas_.resize(point_num - 1);
+            dxs_.resize(point_num - 1);
+            dxs_r_.resize(point_num - 1);
+        }
+
+        /**
+         * set the input Y of a curve at a point
+         * @param curve_idx curve index
+         * @param point_idx point index
+         * @param y input Y
+         */
+        void setY(const size_t curve_idx, const size_t point_idx, const FloatType y) {
+            ys_[point_idx][curve_idx] = y;
+        }
+
+        /**
+         * call this to update derivatives of all curves if input has been updated
+         */
+        void prepare() {
+            for (size_t i = 0; i < dxs_.size(); ++i) {
+                dxs_[i] = xs_[i + 1] - xs_[i];
+                dxs_r_[i] = FloatType(1) / dxs_[i];
+            }
+            for (size_t i = 0; i < deltas_.size(); ++i) {
+                const auto &y0{ys_[i]}, &y1{ys_[i + 1]};
+                auto &delta{deltas_[i]};
+                for (size_t k = 0; k < CurveNum; ++k) {
+                    delta[k] = (y1[k] - y0[k]) * dxs_r_[i];
+                }
+            }
+            Values left_delta, right_delta;
+            for (size_t k = 0; k < CurveNum; ++k) {
+                left_delta[k] = FloatType(2) * deltas_[0][k] - deltas_[1][k];
+                right_delta[k] = FloatType(2) * deltas_.end()[-1][k] - deltas_.end()[-2][k];
+            }
+
+            derivatives_.front().fill(left_derivative_);
+            derivatives_.back().fill(right_derivative_);
+
+            calculateD(left_delta, deltas_[0], deltas_[1], deltas_[2], derivatives_[1]);
+
+            for (size_t i = 2; i < derivatives_.size() - 2; ++i) {
+                calculateD(deltas_[i - 2], deltas_[i - 1], deltas_[i], deltas_[i + 1], derivatives_[i]);
+            }
+
+            calculateD(deltas_.end()[-3], deltas_.end()[-2], deltas_.end()[-1], right_delta,
+                       derivatives_.end()[-2]);
+        }
+
+        /**
+         * evaluate the splines at output X
+         * @param x output X pointer
+         * @param ys output Y pointers, one for each curve
+         * @param point_num number of output points
+         */
+        void eval(const FloatType *x, const std::array<FloatType *, CurveNum> &ys, const size_t point_num) {
+            size_t current_pos = 0;
+            size_t start_idx = 0, end_idx = point_num - 1;
+            while (start_idx <= end_idx && x[start_idx] <= xs_[0]) {
+                for (size_t k = 0; k < CurveNum; ++k) {
+                    ys[k][start_idx] = ys_[0][k];
+                }
+                start_idx += 1;
+            }
+            while (end_idx > start_idx && x[end_idx] >= xs_[input_size_ - 1]) {
+                for (size_t k = 0; k < CurveNum; ++k) {
+                    ys[k][end_idx] = ys_[input_size_ - 1][k];
+                }
+                end_idx -= 1;
+            }
+            for (size_t i = start_idx; i <= end_idx; ++i) {
+                while (current_pos + 2 < input_size_ && x[i] >= xs_[current_pos + 1]) {
+                    current_pos += 1;
+                }
+                // shared basis weights
+                const auto dx = dxs_[current_pos];
+                const auto t = (x[i] - xs_[current_pos]) * dxs_r_[current_pos];
+                const auto w00 = h00(t), w10 = h10(t) * dx, w01 = h01(t), w11 = h11(t) * dx;
+                const auto &y0{ys_[current_pos]}, &y1{ys_[current_pos + 1]};
+                const auto &d0{derivatives_[current_pos]}, &d1{derivatives_[current_pos + 1]};
+                for (size_t k = 0; k < CurveNum; ++k) {
+                    ys[k][i] = w00 * y0[k] + w10 * d0[k] + w01 * y1[k] + w11 * d1[k];
+                }
+            }
+        }
+
+    private:
+        FloatType *xs_;
+        size_t input_size_;
+        std::vector<Values> ys_, derivatives_, deltas_;
+        std::vector<FloatType> dxs_, dxs_r_;
+        FloatType left_derivative_, right_derivative_;
+
+        static FloatType h00(FloatType t) {
+            return (FloatType(1) + FloatType(2) * t) * (FloatType(1) - t) * (FloatType(1) - t);
+        }
+
+        static FloatType h10(FloatType t) {
+            return t * (FloatType(1) - t) * (FloatType(1) - t);
+        }
+
+        static FloatType h01(FloatType t) {
+            return t * t * (FloatType(3) - FloatType(2) * t);
+        }
+
+        static FloatType h11(FloatType t) {
+            return t * t * (t - FloatType(1));
+        }
+
+        static void calculateD(const Values &delta0, const Values &delta1,
+                               const Values &delta2, const Values &delta3, Values &d) {
+            for (size_t k = 0; k < CurveNum; ++k) {
+                const auto w1 = std::abs(delta3[k] - delta2[k]) + std::abs(delta3[k] + delta2[k]) * FloatType(0.5);
+                const auto w2 = std::abs(delta1[k] - delta0[k]) + std::abs(delta1[k] + delta0[k]) * FloatType(0.5);
+                const auto w = w1 / (w1 + w2);
+                d[k] = w * delta1[k] + (FloatType(1) - w) * delta2[k];
+            }
+        }
+    };
+}
@@ -0,0 +1,256 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "../vector/kfr_import.hpp"
+#include "../container/abstract_fifo.hpp"
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
+
+namespace zldsp::analyzer {
+    /**
+     * a stereo phase-correlation meter and goniometer data producer
+     * the audio thread accumulates L*R, L^2 and R^2 over segments of time_length / (PointNum - 1) seconds,
+     * and pushes the sums into a FIFO (the same pattern as MultipleMagBase)
+     * it also pushes every decimation-th sample as a mid/side point into a bounded FIFO, points are dropped if it is full
+     * the UI thread calls run, then reads the correlation history, the smoothed correlation and the points
+     * @tparam FloatType the float type of input audio buffers
+     * @tparam PointNum the number of correlation history points
+     * @tparam MaxPointNum the capacity of the goniometer point FIFO
+     */
+    template<typename FloatType, size_t PointNum, size_t MaxPointNum = 2048>
+    class CorrelationAnalyzer {
+    public:
+        CorrelationAnalyzer() = default;
+
+        void prepare(const double sample_rate) {
+            process_counter_.prepare("zldsp::analyzer::CorrelationAnalyzer::process", this);
+            sample_rate_.store(sample_rate, std::memory_order::relaxed);
+            to_update_time_length_.store(true, std::memory_order::release);
+            std::fill(correlations_.begin(), correlations_.end(), 0.f);
+            smoothed_sums_ = {};
+        }
+
+        /**
+         * accumulate the stereo sums and push goniometer points
+         * @param buffer the left and right buffers
+         * @param num_samples
+         */
+        void process(std::span<FloatType *> buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::analyzer::CorrelationAnalyzer::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            if (num_samples == 0 || buffer.size() < 2) return;
+            if (to_update_time_length_.exchange(false, std::memory_order::acquire)) {
+                segment_size_ = std::max(static_cast<size_t>(1), static_cast<size_t>(std::round(
+                    sample_rate_.load(std::memory_order::relaxed) *
+                    static_cast<double>(time_length_.load(std::memory_order::relaxed)) /
+                    static_cast<double>(PointNum - 1))));
+                current_pos_ = 0;
+                current_sums_ = {};
+            }
+            size_t start_idx = 0;
+            while (start_idx < num_samples) {
+                const auto num = std::min(num_samples - start_idx, segment_size_ - current_pos_);
+                auto l = kfr::make_univector(buffer[0] + start_idx, num);
+                auto r = kfr::make_univector(buffer[1] + start_idx, num);
+                current_sums_[0] += kfr::dotproduct(l, r);
+                current_sums_[1] += kfr::sumsqr(l);
+                current_sums_[2] += kfr::sumsqr(r);
+                current_pos_ += num;
+                start_idx += num;
+                if (current_pos_ == segment_size_) {
+                    if (sum_fifo_.planWrite(1).num_to_write > 0) {
+                        const auto range = sum_fifo_.prepareToWrite(1);
+                        const auto write_idx = static_cast<size_t>(range.block_size1 > 0 ? range.start_index1 : range.start_index2);
+                        for (size_t k = 0; k < 3; ++k) {
+                            sum_fifos_[k][write_idx] = static_cast<float>(current_sums_[k]);
+                        }
+                        sum_fifo_.finishWrite(1);
+                    }
+                    current_pos_ = 0;
+                    current_sums_ = {};
+                }
+            }
+            // goniometer points
+            const auto decimation = decimation_.load(std::memory_order::relaxed);
+            size_t i = decimation_pos_;
+            const auto num_points = i < num_samples ? (num_samples - i + decimation - 1) / decimation : 0;
+            const auto plan = point_fifo_.planWrite(static_cast<int>(num_points));
+            if (plan.num_to_write > 0) {
+                const auto range = point_fifo_.prepareToWrite(plan.num_to_write);
+                i += static_cast<size_t>(plan.offset) * decimation;
+                const auto step = static_cast<size_t>(plan.step) * decimation;
+                for (int k = 0; k < range.block_size1 + range.block_size2; ++k) {
+                    const auto idx = static_cast<size_t>(k < range.block_size1
+                                                             ? range.start_index1 + k
+                                                             : range.start_index2 + k - range.block_size1);
+                    const auto l = buffer[0][i], r = buffer[1][i];
+                    mids_[idx] = static_cast<float>(kSqrt2Over2 * (l + r));
+                    sides_[idx] = static_cast<float>(kSqrt2Over2 * (l - r));
+                    i += step;
+                }
+                point_fifo_.finishWrite(plan.num_to_write);
+            }
+            // keep the decimation phase even if points have been dropped
+            i = decimation_pos_ + num_points * decimation;
+            decimation_pos_ = i - num_samples;
+        }
+
+        /**
+         * read the FIFO, update the correlation history and the smoothed correlation
+         * @return the number of new correlation points
+         */
+        int run() {
+            sum_fifo_.applyResync();
+            const int num_ready = sum_fifo_.getNumReady();
+            if (num_ready <= 0) return 0;
+            const auto range = sum_fifo_.prepareToRead(num_ready);
+            const auto decay = smooth_decay_.load(std::memory_order::relaxed);
+            const auto shift = std::min(static_cast<size_t>(num_ready), PointNum);
+            std::rotate(correlations_.begin(), correlations_.begin() + static_cast<std::ptrdiff_t>(shift),
+                        correlations_.end());
+            size_t j = PointNum - shift;
+            for (int k = 0; k < num_ready; ++k) {
+                const auto idx = static_cast<size_t>(k < range.block_size1
+                                                         ? range.start_index1 + k
+                                                         : range.start_index2 + k - range.block_size1);
+                std::array<float, 3> sums{sum_fifos_[0][idx], sum_fifos_[1][idx], sum_fifos_[2][idx]};
+                for (size_t s = 0; s < 3; ++s) {
+                    smoothed_sums_[s] = smoothed_sums_[s] * decay + sums[s];
+                }
+                // only the last PointNum points fit into the history
+                if (k >= num_ready - static_cast<int>(shift)) {
+                    correlations_[j] = getCorrelation(sums);
+                    j += 1;
+                }
+            }
+            sum_fifo_.finishRead(num_ready);
+            smoothed_correlation_ = getCorrelation(smoothed_sums_);
+            return num_ready;
+        }
+
+        /**
+         * pop goniometer points
+         * @param mids
+         * @param sides
+         * @return the number of points written
+         */
+        size_t popPoints(std::span<float> mids, std::span<float> sides) {
+            point_fifo_.applyResync();
+            const int num_ready = std::min(point_fifo_.getNumReady(), static_cast<int>(std::min(mids.size(), sides.size())));
+            if (num_ready <= 0) return 0;
+            const auto range = point_fifo_.prepareToRead(num_ready);
+            for (int k = 0; k < num_ready; ++k) {
+                const auto idx = static_cast<size_t>(k < range.block_size1
+                                                         ? range.start_index1 + k
+                                                         : range.start_index2 + k - range.block_size1);
+                mids[static_cast<size_t>(k)] = mids_[idx];
+                sides[static_cast<size_t>(k)] = sides_[idx];
+            }
+            point_fifo_.finishRead(num_ready);
+            return static_cast<size_t>(num_ready);
+        }
+
+        /**
+         * @return the correlation of each segment in [-1, 1], the newest is at the end
+         */
+        const std::array<float, PointNum> &getCorrelations() const { return correlations_; }
+
+        /**
+         * @return the correlation of the exponentially averaged sums
+         */
+        float getSmoothedCorrelation() const { return smoothed_correlation_; }
+
+        void setTimeLength(const float x) {
+            time_length_.store(x, std::memory_order::relaxed);
+            to_update_time_length_.store(true, std::memory_order::release);
+        }
+
+        /**
+         * @param x the decay of the averaged sums per segment
+         */
+        void setSmoothDecay(const float x) {
+            smooth_decay_.store(std::clamp(x, 0.f, 1.f), std::memory_order::relaxed);
+        }
+
+        /**
+         * @param x push one goniometer point every x samples
+         */
+        void setDecimation(const size_t x) {
+            decimation_.store(std::max(x, static_cast<size_t>(1)), std::memory_order::relaxed);
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @param x what process does when run / popPoints fall behind
+         */
+        void setOverflowPolicy(const zldsp::container::OverflowPolicy x) {
+            sum_fifo_.setOverflowPolicy(x);
+            point_fifo_.setOverflowPolicy(x);
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @return the number of correlation points and goniometer points dropped by the FIFOs
+         */
+        std::array<std::uint64_t, 2> getFIFODroppedCounts() const {
+            return {sum_fifo_.getDroppedCount(), point_fifo_.getDroppedCount()};
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @return the maximum number of correlation points and goniometer points waiting in the FIFOs
+         */
+        std::array<int, 2> getFIFOHighWaters() const {
+            return {sum_fifo_.getHighWater(), point_fifo_.getHighWater()};
+        }
+
+        void resetFIFOStats() {
+            sum_fifo_.resetStats();
+            point_fifo_.resetStats();
+        }
+
+    private:
+        static constexpr FloatType kSqrt2Over2 = static_cast<FloatType>(
+            0.7071067811865475244008443621048490392848359376884740365883398690);
+
+        std::atomic<double> sample_rate_{48000.0};
+        std::atomic<float> time_length_{7.f};
+        chore::CycleCounter process_counter_;
+        std::atomic<bool> to_update_time_length_{true};
+        size_t segment_size_{1}, current_pos_{0};
+        std::array<FloatType, 3> current_sums_{};
+
+        // L*R, L^2, R^2
+        std::array<std::array<float, PointNum>, 3> sum_fifos_{};
+        zldsp::container::AbstractFIFO sum_fifo_{static_cast<int>(PointNum)};
+
+        std::atomic<size_t> decimation_{16};
+        size_t decimation_pos_{0};
+        std::array<float, MaxPointNum> mids_{}, sides_{};
+        zldsp::container::AbstractFIFO point_fifo_{static_cast<int>(MaxPointNum)};
+
+        std::array<float, PointNum> correlations_{};
+        std::array<float, 3> smoothed_sums_{};
+        std::atomic<float> smooth_decay_{.9f};
+        float smoothed_correlation_{0.f};
+
+        static float getCorrelation(const std::array<float, 3> &sums) {
+            const auto denominator = std::sqrt(sums[1] * sums[2]);
+            return denominator > 1e-12f ? std::clamp(sums[0] / denominator, -1.f, 1.f) : 0.f;
+        }
+    };
+}
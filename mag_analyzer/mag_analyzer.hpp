@@ -12,3 +12,5 @@
 #include "multiple_mag_analyzer.hpp"
 #include "mag_reduction_analyzer.hpp"
 #include "multiple_mag_avg_analyzer.hpp"
+#include "correlation_analyzer.hpp"
+#include "octave_analyzer.hpp"
@@ -20,17 +20,23 @@ namespace zldsp::analyzer {
         ~MultipleMagAnalyzer() override = default;
 
         void prepare(const double sample_rate) override {
+            this->process_counter_.prepare("zldsp::analyzer::MultipleMagBase::process", this);
             this->sample_rate_.store(sample_rate, std::memory_order::relaxed);
             this->setTimeLength(this->time_length_.load(std::memory_order::relaxed));
-            std::fill(this->current_mags_.begin(), this->current_mags_.end(), FloatType(-999));
+            std::fill(this->current_mags_.begin(), this->current_mags_.end(), FloatType(0));
         }
 
         int run(const int num_to_read = PointNum) {
             // calculate the number of points put into circular buffers
+            this->abstract_fifo_.applyResync();
             const int fifo_num_ready = this->abstract_fifo_.getNumReady();
+            const auto is_stats = this->mag_type_.load(std::memory_order::acquire) == MagType::kStats;
             if (this->to_reset_.exchange(false, std::memory_order::acquire)) {
                 for (size_t i = 0; i < MagNum; ++i) {
                     std::fill(this->circular_mags_[i].begin(), this->circular_mags_[i].end(), -240.f);
+                    if (is_stats) {
+                        std::fill(this->circular_stats_[i].begin(), this->circular_stats_[i].end(), MagStats{});
+                    }
                 }
                 // clear FIFOs
                 this->abstract_fifo_.prepareToRead(fifo_num_ready);
@@ -49,8 +55,29 @@ namespace zldsp::analyzer {
                             circular_peak.begin() + num_ready_shift,
                             circular_peak.end());
             }
+            if (is_stats) {
+                for (size_t i = 0; i < MagNum; ++i) {
+                    auto &circular_stats{this->circular_stats_[i]};
+                    std::rotate(circular_stats.begin(),
+                                circular_stats.begin() + num_ready_shift,
+                                circular_stats.end());
+                }
+            }
             // read from FIFOs
             const auto range = this->abstract_fifo_.prepareToRead(num_ready);
+            if (is_stats) {
+                for (size_t i = 0; i < MagNum; ++i) {
+                    auto &circular_stats{this->circular_stats_[i]};
+                    auto &stats_fifo{this->stats_fifos_[i]};
+                    size_t j = circular_stats.size() - static_cast<size_t>(num_ready);
+                    for (int k = 0; k < range.block_size1; ++k) {
+                        circular_stats[j++] = stats_fifo[static_cast<size_t>(range.start_index1 + k)];
+                    }
+                    for (int k = 0; k < range.block_size2; ++k) {
+                        circular_stats[j++] = stats_fifo[static_cast<size_t>(range.start_index2 + k)];
+                    }
+                }
+            }
             for (size_t i = 0; i < MagNum; ++i) {
                 auto &circular_peak{this->circular_mags_[i]};
                 auto &peak_fifo{this->mag_fifos_[i]};
@@ -87,5 +114,59 @@ namespace zldsp::analyzer {
                 y_vector = (max_db - mag_vector) * scale;
             }
         }
+
+        /**
+         * create paths of one statistic, only valid in the kStats mode
+         * peak, RMS and crest are mapped from [min_db, max_db], min and max sample values from [-1, 1]
+         */
+        void createStatPath(std::span<float> xs, std::array<std::span<float>, MagNum> ys,
+                            const MagStatType stat_type,
+                            const float width, const float height, const float shift = 0.f,
+                            const float min_db = -72.f, const float max_db = 0.f) {
+            const auto delta_x = width / static_cast<float>(PointNum - 1);
+            xs[0] = -shift * delta_x;
+            for (size_t idx = 1; idx < PointNum; ++idx) {
+                xs[idx] = xs[idx - 1] + delta_x;
+            }
+            const float db_scale = height / (max_db - min_db);
+            const float linear_scale = height * .5f;
+            for (size_t i = 0; i < MagNum; ++i) {
+                const auto &circular_stats{this->circular_stats_[i]};
+                if (circular_stats.empty()) continue;
+                auto &y{ys[i]};
+                for (size_t idx = 0; idx < PointNum; ++idx) {
+                    const auto &stats{circular_stats[idx]};
+                    switch (stat_type) {
+                        case kStatPeak: {
+                            y[idx] = (max_db - stats.peak_db) * db_scale;
+                            break;
+                        }
+                        case kStatRMS: {
+                            y[idx] = (max_db - stats.rms_db) * db_scale;
+                            break;
+                        }
+                        case kStatCrest: {
+                            y[idx] = (max_db - stats.getCrestDB()) * db_scale;
+                            break;
+                        }
+                        case kStatMin: {
+                            y[idx] = (1.f - stats.min) * linear_scale;
+                            break;
+                        }
+                        case kStatMax: {
+                            y[idx] = (1.f - stats.max) * linear_scale;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * @return the statistics of each point, only valid (and non-empty) in the kStats mode
+         */
+        const std::array<std::vector<MagStats>, MagNum> &getStats() const {
+            return this->circular_stats_;
+        }
     };
 }
@@ -20,9 +20,10 @@ namespace zldsp::analyzer {
         ~MultipleMagAvgAnalyzer() override = default;
 
         void prepare(const double sample_rate) override {
+            this->process_counter_.prepare("zldsp::analyzer::MultipleMagBase::process", this);
             this->sample_rate_.store(sample_rate, std::memory_order::relaxed);
             this->setTimeLength(0.001f * 999.0f);
-            std::fill(this->current_mags_.begin(), this->current_mags_.end(), FloatType(-999));
+            std::fill(this->current_mags_.begin(), this->current_mags_.end(), FloatType(0));
         }
 
         void run() {
@@ -33,6 +34,7 @@ namespace zldsp::analyzer {
                 }
             }
 
+            this->abstract_fifo_.applyResync();
             const int num_ready = this->abstract_fifo_.getNumReady();
             const auto range = this->abstract_fifo_.prepareToRead(num_ready);
             for (size_t i = 0; i < MagNum; ++i) {
@@ -9,16 +9,40 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <span>
 #include <atomic>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
 
 #include "../vector/kfr_import.hpp"
 #include "../chore/decibels.hpp"
 #include "../container/abstract_fifo.hpp"
+#include "../container/broadcast_ring.hpp"
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
 
 namespace zldsp::analyzer {
     enum MagType {
-        kPeak, kRMS
+        kPeak, kRMS, kStats
+    };
+
+    enum MagStatType {
+        kStatPeak, kStatRMS, kStatCrest, kStatMin, kStatMax
+    };
+
+    /**
+     * the statistics of one point, pushed into the FIFO in the kStats mode
+     */
+    struct MagStats {
+        float peak_db{-240.f}, rms_db{-240.f};
+        // the minimum and maximum sample values
+        float min{0.f}, max{0.f};
+
+        [[nodiscard]] float getCrestDB() const { return peak_db - rms_db; }
     };
 
     template<typename FloatType, size_t MagNum, size_t PointNum>
@@ -32,7 +56,9 @@ namespace zldsp::analyzer {
 
         void process(std::array<std::span<FloatType *>, MagNum> buffers,
                      const size_t num_samples) {
-            switch (mag_type_.load(std::memory_order::relaxed)) {
+            ZLDSP_REALTIME_SCOPE("zldsp::analyzer::MultipleMagBase::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            switch (mag_type_.load(std::memory_order::acquire)) {
                 case MagType::kPeak: {
                     processBuffer<MagType::kPeak>(buffers, static_cast<int>(num_samples));
                     break;
@@ -41,11 +67,34 @@ namespace zldsp::analyzer {
                     processBuffer<MagType::kRMS>(buffers, static_cast<int>(num_samples));
                     break;
                 }
+                case MagType::kStats: {
+                    processBuffer<MagType::kStats>(buffers, static_cast<int>(num_samples));
+                    break;
+                }
                 default: {
                 }
             }
         }
 
+        /**
+         * process the ready samples of a BroadcastReaderGroup, instead of calling process on the audio thread
+         * call it on the thread that owns the group, e.g. right before run
+         * @param group one reader per magnitude
+         */
+        void pull(zldsp::container::BroadcastReaderGroup<FloatType, MagNum> &group) {
+            std::array<std::span<FloatType *>, MagNum> buffers;
+            while (true) {
+                const auto num_samples = group.read();
+                // there are no timestamps, the samples skipped by overrun readers are simply lost
+                group.popNumSkipped();
+                if (num_samples == 0) return;
+                for (size_t i = 0; i < MagNum; ++i) {
+                    buffers[i] = group.getBuffer(i);
+                }
+                process(buffers, num_samples);
+            }
+        }
+
         void setTimeLength(const float x) {
             time_length_.store(x, std::memory_order::relaxed);
             to_update_time_length_.store(true, std::memory_order::release);
@@ -53,23 +102,66 @@ namespace zldsp::analyzer {
 
         void setToReset() { to_reset_.store(true, std::memory_order::release); }
 
-        void setMagType(const MagType x) { mag_type_.store(x, std::memory_order::relaxed); }
+        /**
+         * not real-time safe when switching to kStats for the first time, which allocates the statistics buffers
+         * @param x
+         */
+        void setMagType(const MagType x) {
+            if (x == MagType::kStats && stats_fifos_[0].empty()) {
+                for (size_t i = 0; i < MagNum; ++i) {
+                    stats_fifos_[i].resize(PointNum);
+                    circular_stats_[i].resize(PointNum);
+                }
+            }
+            mag_type_.store(x, std::memory_order::release);
+        }
+
+        /**
+         * thread-safe, lock-free
+         * @param x what process does when run falls behind, kDecimate acts like kDropNewest on single points
+         */
+        void setOverflowPolicy(const zldsp::container::OverflowPolicy x) { abstract_fifo_.setOverflowPolicy(x); }
+
+        /**
+         * thread-safe, lock-free
+         * @return the number of points dropped by the FIFO
+         */
+        std::uint64_t getFIFODroppedCount() const { return abstract_fifo_.getDroppedCount(); }
+
+        /**
+         * thread-safe, lock-free
+         * @return the maximum number of points waiting in the FIFO
+         */
+        int getFIFOHighWater() const { return abstract_fifo_.getHighWater(); }
+
+        void resetFIFOStats() { abstract_fifo_.resetStats(); }
 
     protected:
+        // the number of partial results of updateStats, one 64-byte vector
+        static constexpr size_t kStatsLaneNum = 64 / sizeof(FloatType);
+
         std::atomic<double> sample_rate_{48000.0};
         std::array<std::array<float, PointNum>, MagNum> mag_fifos_{};
         zldsp::container::AbstractFIFO abstract_fifo_{PointNum};
         std::array<std::array<float, PointNum>, MagNum> circular_mags_{};
         size_t circular_idx_{0};
+        // allocated when the kStats mode is set for the first time
+        std::array<std::vector<MagStats>, MagNum> stats_fifos_{};
+        std::array<std::vector<MagStats>, MagNum> circular_stats_{};
 
         std::atomic<float> time_length_{7.f};
         double current_pos_{0.}, max_pos_{1.};
         int current_num_samples_{0};
         std::atomic<bool> to_update_time_length_{true};
         std::array<FloatType, MagNum> current_mags_{};
+        // min, max and sum of squares of the kStats mode
+        std::array<std::array<FloatType, 3>, MagNum> current_stats_{getEmptyStats<MagNum>()};
+        std::array<size_t, MagNum> current_stats_num_samples_{};
 
         std::atomic<bool> to_reset_{false};
         std::atomic<MagType> mag_type_{MagType::kRMS};
+        // registered by the prepare of the derived class
+        chore::CycleCounter process_counter_;
 
         template<MagType CurrentMagType>
         void processBuffer(std::array<std::span<FloatType *>, MagNum> &buffers, int num_samples) {
@@ -89,31 +181,7 @@ namespace zldsp::analyzer {
                     num_samples -= remain_num;
                     updateMags<CurrentMagType>(buffers, start_idx, remain_num);
                     current_pos_ = current_pos_ + static_cast<double>(remain_num) - max_pos_;
-                    if (abstract_fifo_.getNumFree() > 0) {
-                        const auto range = abstract_fifo_.prepareToWrite(1);
-                        const auto write_idx = range.block_size1 > 0 ? range.start_index1 : range.start_index2;
-                        switch (CurrentMagType) {
-                            case MagType::kPeak: {
-                                for (size_t i = 0; i < MagNum; ++i) {
-                                    mag_fifos_[i][static_cast<size_t>(write_idx)] = zldsp::chore::gainToDecibels(
-                                        static_cast<float>(current_mags_[i]));
-                                }
-                                break;
-                            }
-                            case MagType::kRMS: {
-                                for (size_t i = 0; i < MagNum; ++i) {
-                                    mag_fifos_[i][static_cast<size_t>(write_idx)] = 0.5f * zldsp::chore::gainToDecibels(
-                                            static_cast<float>(
-                                                current_mags_[i] / static_cast<FloatType>(current_num_samples_)));
-                                }
-                                current_num_samples_ = 0;
-                                break;
-                            }
-                        }
-                        abstract_fifo_.finishWrite(1);
-
-                        std::fill(current_mags_.begin(), current_mags_.end(), FloatType(0));
-                    }
+                    pushPoint<CurrentMagType>();
                 } else {
                     updateMags<CurrentMagType>(buffers, start_idx, num_samples);
                     current_pos_ += static_cast<double>(num_samples);
@@ -122,6 +190,57 @@ namespace zldsp::analyzer {
             }
         }
 
+        /**
+         * push the accumulated point into the FIFO and start a new one, a dropped point is counted by the FIFO
+         */
+        template<MagType CurrentMagType>
+        void pushPoint() {
+            const auto plan = abstract_fifo_.planWrite(1);
+            const auto to_write = plan.num_to_write > 0;
+            size_t write_idx = 0;
+            if (to_write) {
+                const auto range = abstract_fifo_.prepareToWrite(1);
+                write_idx = static_cast<size_t>(range.block_size1 > 0 ? range.start_index1 : range.start_index2);
+            }
+            switch (CurrentMagType) {
+                case MagType::kPeak: {
+                    if (to_write) {
+                        for (size_t i = 0; i < MagNum; ++i) {
+                            mag_fifos_[i][write_idx] = zldsp::chore::gainToDecibels(
+                                static_cast<float>(current_mags_[i]));
+                        }
+                    }
+                    break;
+                }
+                case MagType::kRMS: {
+                    if (to_write) {
+                        for (size_t i = 0; i < MagNum; ++i) {
+                            mag_fifos_[i][write_idx] = 0.5f * zldsp::chore::gainToDecibels(
+                                                           static_cast<float>(
+                                                               current_mags_[i] / static_cast<FloatType>(
+                                                                   current_num_samples_)));
+                        }
+                    }
+                    current_num_samples_ = 0;
+                    break;
+                }
+                case MagType::kStats: {
+                    for (size_t i = 0; i < MagNum; ++i) {
+                        const auto stats = popStats(i);
+                        if (to_write) {
+                            stats_fifos_[i][write_idx] = stats;
+                            mag_fifos_[i][write_idx] = stats.rms_db;
+                        }
+                    }
+                    break;
+                }
+            }
+            if (to_write) {
+                abstract_fifo_.finishWrite(1);
+            }
+            std::fill(current_mags_.begin(), current_mags_.end(), FloatType(0));
+        }
+
         template<MagType CurrentMagType>
         void updateMags(std::array<std::span<FloatType *>, MagNum> &buffers,
                         const int start_idx, const int num_samples) {
@@ -141,9 +260,81 @@ namespace zldsp::analyzer {
                             current_num_samples_ += num_samples;
                             break;
                         }
+                        case MagType::kStats: {
+                            updateStats(i, v);
+                            break;
+                        }
                     }
                 }
             }
         }
+
+        /**
+         * accumulate min, max and sum of squares, the peak is derived from min and max
+         * one sweep over the block with per-lane partial results, so that it vectorizes without reassociating the sum
+         * @param i
+         * @param v
+         */
+        template<typename VectorType>
+        void updateStats(const size_t i, const VectorType &v) {
+            auto &stats{current_stats_[i]};
+            std::array<FloatType, kStatsLaneNum> mins, maxs, sums{};
+            mins.fill(stats[0]);
+            maxs.fill(stats[1]);
+            const auto *data = v.data();
+            const auto num_samples = v.size();
+            const auto num_full = num_samples - num_samples % kStatsLaneNum;
+            for (size_t idx = 0; idx < num_full; idx += kStatsLaneNum) {
+                for (size_t lane = 0; lane < kStatsLaneNum; ++lane) {
+                    const auto x = data[idx + lane];
+                    mins[lane] = std::min(mins[lane], x);
+                    maxs[lane] = std::max(maxs[lane], x);
+                    sums[lane] += x * x;
+                }
+            }
+            for (size_t idx = num_full; idx < num_samples; ++idx) {
+                const auto x = data[idx];
+                mins[0] = std::min(mins[0], x);
+                maxs[0] = std::max(maxs[0], x);
+                sums[0] += x * x;
+            }
+            stats = {
+                *std::min_element(mins.begin(), mins.end()),
+                *std::max_element(maxs.begin(), maxs.end()),
+                stats[2] + std::accumulate(sums.begin(), sums.end(), FloatType(0))
+            };
+            current_stats_num_samples_[i] += num_samples;
+        }
+
+        /**
+         * convert the accumulated statistics into a record and start a new one
+         * @param i
+         * @return
+         */
+        MagStats popStats(const size_t i) {
+            auto &stats{current_stats_[i]};
+            MagStats record{};
+            const auto num_samples = current_stats_num_samples_[i];
+            if (num_samples > 0) {
+                const auto peak = std::max(std::abs(stats[0]), std::abs(stats[1]));
+                record.peak_db = zldsp::chore::gainToDecibels(static_cast<float>(peak));
+                record.rms_db = 0.5f * zldsp::chore::gainToDecibels(
+                                    static_cast<float>(stats[2] / static_cast<FloatType>(num_samples)));
+                record.min = static_cast<float>(stats[0]);
+                record.max = static_cast<float>(stats[1]);
+            }
+            stats = getEmptyStats<1>()[0];
+            current_stats_num_samples_[i] = 0;
+            return record;
+        }
+
+        template<size_t Num>
+        static constexpr std::array<std::array<FloatType, 3>, Num> getEmptyStats() {
+            std::array<std::array<FloatType, 3>, Num> stats{};
+            for (auto &s: stats) {
+                s = {std::numeric_limits<FloatType>::max(), std::numeric_limits<FloatType>::lowest(), FloatType(0)};
+            }
+            return stats;
+        }
     };
 }
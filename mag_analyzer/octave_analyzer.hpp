@@ -0,0 +1,419 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "multiple_mag_analyzer.hpp"
+#include "../filter/iir_filter/coeff/martin_coeff.hpp"
+#include "../filter/filter_design/filter_design.hpp"
+#include "../over_sample/over_sample_stage.hpp"
+#include "../over_sample/halfband_coeffs.hpp"
+
+namespace zldsp::analyzer {
+    /**
+     * a fractional-octave real-time analyzer (IEC 61260-style band filters) built as a multirate octave tree
+     * the top octave runs at the sample rate, each lower octave is decimated by 2 with a half-band stage,
+     * so all octaves share the same normalized bandpass coefficients
+     * each band is a cascade of two identical bandpass biquads whose -3 dB edges are the nominal band edges,
+     * the bands of an octave run side by side in one sample loop, so that the compiler vectorizes across the bands
+     * band levels (peak, RMS or statistics) are pushed into the MultipleMagBase FIFO once per segment, call run on the UI thread
+     * the group delays of the octaves differ, which does not matter for metering
+     * @tparam FloatType the float type of input audio buffers
+     * @tparam BandsPerOctave 1 for octave bands, 3 for third-octave bands, etc.
+     * @tparam OctaveNum the number of octaves
+     * @tparam PointNum the number of points of each band history
+     */
+    template<typename FloatType, size_t BandsPerOctave, size_t OctaveNum, size_t PointNum>
+    class OctaveAnalyzer : public MultipleMagAnalyzer<FloatType, BandsPerOctave * OctaveNum, PointNum> {
+    public:
+        static constexpr size_t kBandNum = BandsPerOctave * OctaveNum;
+        static constexpr size_t kSectionNum = 2;
+        // the upper edge of the highest band relative to the sample rate, below the half-band passband edge
+        static constexpr double kMaxEdge = 0.4;
+
+        OctaveAnalyzer() {
+            static_assert(BandsPerOctave >= 1);
+            static_assert(OctaveNum >= 1);
+            for (size_t k = 1; k < OctaveNum; ++k) {
+                stages_.emplace_back(std::span(kHalfbandCoeff), std::span(kHalfbandCoeff));
+            }
+        }
+
+        ~OctaveAnalyzer() override = default;
+
+        /**
+         * call before processing starts, the only way to prepare the analyzer
+         * @param sample_rate
+         * @param num_channels
+         * @param max_num_samples the maximum number of samples per process call
+         */
+        void prepare(const double sample_rate, const size_t num_channels, const size_t max_num_samples) {
+            octave_counter_.prepare("zldsp::analyzer::OctaveAnalyzer::process", this);
+            num_channels_ = num_channels;
+            max_num_samples_ = max_num_samples;
+            for (auto &stage: stages_) {
+                stage.prepare(num_channels, max_num_samples);
+            }
+            octave_buffers_.resize(OctaveNum);
+            octave_pointers_.resize(OctaveNum);
+            for (size_t k = 1; k < OctaveNum; ++k) {
+                octave_buffers_[k].resize(num_channels);
+                octave_pointers_[k].resize(num_channels);
+                for (size_t chan = 0; chan < num_channels; ++chan) {
+                    octave_buffers_[k][chan].resize((max_num_samples >> k) + 1);
+                    octave_pointers_[k][chan] = octave_buffers_[k][chan].data();
+                }
+            }
+            octave_pointers_[0].resize(num_channels);
+            band_frames_.resize(num_channels);
+            for (auto &frames: band_frames_) {
+                frames.resize(max_num_samples * BandsPerOctave);
+            }
+            band_states_.resize(OctaveNum);
+            for (auto &octave_states: band_states_) {
+                octave_states.resize(num_channels);
+                std::fill(octave_states.begin(), octave_states.end(), std::array<BandState, kSectionNum>{});
+            }
+            std::fill(carries_.begin(), carries_.end(), static_cast<size_t>(0));
+            updateBands(sample_rate);
+            MultipleMagAnalyzer<FloatType, kBandNum, PointNum>::prepare(sample_rate);
+            std::fill(this->current_mags_.begin(), this->current_mags_.end(), FloatType(0));
+            std::fill(band_num_samples_.begin(), band_num_samples_.end(), static_cast<size_t>(0));
+            std::fill(last_dbs_.begin(), last_dbs_.end(), -240.f);
+            std::fill(last_stats_.begin(), last_stats_.end(), MagStats{});
+        }
+
+        /**
+         * feed a buffer through the octave tree and update the band levels
+         * @param buffer
+         * @param num_samples must not exceed max_num_samples
+         */
+        void process(std::span<FloatType *> buffer, const size_t num_samples) {
+            ZLDSP_REALTIME_SCOPE("zldsp::analyzer::OctaveAnalyzer::process");
+            ZLDSP_CYCLE_COUNTER(octave_counter_, num_samples);
+            assert(num_samples <= max_num_samples_ && buffer.size() <= num_channels_);
+            switch (this->mag_type_.load(std::memory_order::acquire)) {
+                case MagType::kPeak: {
+                    processBuffer<MagType::kPeak>(buffer, num_samples);
+                    break;
+                }
+                case MagType::kRMS: {
+                    processBuffer<MagType::kRMS>(buffer, num_samples);
+                    break;
+                }
+                case MagType::kStats: {
+                    processBuffer<MagType::kStats>(buffer, num_samples);
+                    break;
+                }
+                default: {
+                }
+            }
+        }
+
+        /**
+         * @param band the band index, from low to high frequencies
+         * @return the nominal center frequency of the band
+         */
+        [[nodiscard]] double getCenterFreq(const size_t band) const { return center_freqs_[band]; }
+
+        /**
+         * process the ready samples of a BroadcastReaderGroup, instead of calling process on the audio thread
+         * call it on the thread that owns the group, e.g. right before run
+         * @param group one reader of the input, whose block size must not exceed max_num_samples
+         */
+        void pull(zldsp::container::BroadcastReaderGroup<FloatType, 1> &group) {
+            while (true) {
+                const auto num_samples = group.read();
+                group.popNumSkipped();
+                if (num_samples == 0) return;
+                process(group.getBuffer(0), num_samples);
+            }
+        }
+
+        // the band buffers of MultipleMagBase bypass the octave tree
+        void process(std::array<std::span<FloatType *>, kBandNum> buffers, size_t num_samples) = delete;
+
+        void pull(zldsp::container::BroadcastReaderGroup<FloatType, kBandNum> &group) = delete;
+
+    private:
+        /**
+         * the sample rate alone does not size the octave buffers, use the sized prepare instead
+         */
+        void prepare(const double sample_rate) override {
+            assert(max_num_samples_ > 0 && "call prepare(sample_rate, num_channels, max_num_samples) first");
+            prepare(sample_rate, num_channels_, max_num_samples_);
+        }
+
+        static constexpr std::array kHalfbandCoeff = oversample::halfband_coeff::convert<FloatType>(
+            oversample::halfband_coeff::kCoeff_64_10_100);
+
+        std::vector<oversample::OverSampleStage<FloatType> > stages_;
+        // whether the stage feeding octave k holds an odd input sample from the last call
+        std::array<size_t, OctaveNum> carries_{};
+        std::vector<std::vector<std::vector<FloatType> > > octave_buffers_;
+        std::vector<std::vector<FloatType *> > octave_pointers_;
+        size_t num_channels_{1}, max_num_samples_{0};
+        chore::CycleCounter octave_counter_;
+
+        // the transposed direct form II states of one section for all bands of an octave
+        struct BandState {
+            std::array<FloatType, BandsPerOctave> s1{}, s2{};
+        };
+
+        // b0, b1, b2, a1, a2 of each section for all bands of an octave, shared by all octaves
+        std::array<std::array<std::array<FloatType, BandsPerOctave>, 5>, kSectionNum> band_coeffs_{};
+        // the states of each octave and channel
+        std::vector<std::vector<std::array<BandState, kSectionNum> > > band_states_;
+        // the band outputs of each channel, frame by frame, i.e. band j of sample i is at i * BandsPerOctave + j
+        std::vector<std::vector<FloatType> > band_frames_;
+        std::array<double, kBandNum> center_freqs_{};
+        std::array<size_t, kBandNum> band_num_samples_{};
+        std::array<float, kBandNum> last_dbs_{};
+        std::array<MagStats, kBandNum> last_stats_{};
+
+        void updateBands(const double sample_rate) {
+            // IEC 61260 base-2 mid-band frequencies, offset by half a band if the number of bands is even
+            const auto b = static_cast<double>(BandsPerOctave);
+            const auto offset = BandsPerOctave % 2 == 0 ? 0.5 : 0.0;
+            const auto half_band = std::pow(2.0, 0.5 / b);
+            const auto top_idx = std::floor(b * std::log2(kMaxEdge * sample_rate / half_band / 1000.0) - offset);
+            const auto top_freq = 1000.0 * std::pow(2.0, (top_idx + offset) / b);
+            // the Q of a bandwidth of 1/BandsPerOctave octaves
+            const auto q = 0.5 / std::sinh(std::log(2.0) * 0.5 / b);
+            std::array<std::array<double, 6>, kSectionNum> coeffs{};
+            for (size_t j = 0; j < BandsPerOctave; ++j) {
+                const auto freq = top_freq * std::pow(2.0, -static_cast<double>(BandsPerOctave - 1 - j) / b);
+                filter::FilterDesign::updateBandPassCoeffs<kSectionNum, filter::MartinCoeff::get2BandPass>(
+                    kSectionNum * 2, 0, filter::ppi * freq / sample_rate, q, coeffs);
+                for (size_t s = 0; s < kSectionNum; ++s) {
+                    const auto a0_inv = 1.0 / coeffs[s][0];
+                    band_coeffs_[s][0][j] = static_cast<FloatType>(coeffs[s][3] * a0_inv);
+                    band_coeffs_[s][1][j] = static_cast<FloatType>(coeffs[s][4] * a0_inv);
+                    band_coeffs_[s][2][j] = static_cast<FloatType>(coeffs[s][5] * a0_inv);
+                    band_coeffs_[s][3][j] = static_cast<FloatType>(coeffs[s][1] * a0_inv);
+                    band_coeffs_[s][4][j] = static_cast<FloatType>(coeffs[s][2] * a0_inv);
+                }
+                for (size_t k = 0; k < OctaveNum; ++k) {
+                    const auto band = (OctaveNum - 1 - k) * BandsPerOctave + j;
+                    center_freqs_[band] = freq / static_cast<double>(1 << k);
+                }
+            }
+        }
+
+        template<MagType CurrentMagType>
+        void processBuffer(std::span<FloatType *> buffer, size_t num_samples) {
+            if (num_samples == 0) { return; }
+            if (this->to_update_time_length_.exchange(false, std::memory_order::acquire)) {
+                this->max_pos_ = this->sample_rate_.load(std::memory_order::relaxed) * static_cast<double>(
+                                     this->time_length_.load(std::memory_order::relaxed)) / static_cast<double>(
+                                     PointNum - 1);
+                this->current_pos_ = 0;
+            }
+            size_t start_idx{0};
+            while (true) {
+                const auto remain_num = static_cast<size_t>(std::max(
+                    std::round(this->max_pos_ - this->current_pos_), 0.0));
+                if (num_samples >= remain_num) {
+                    processChunk<CurrentMagType>(buffer, start_idx, remain_num);
+                    start_idx += remain_num;
+                    num_samples -= remain_num;
+                    this->current_pos_ = this->current_pos_ + static_cast<double>(remain_num) - this->max_pos_;
+                    pushMags<CurrentMagType>();
+                } else {
+                    processChunk<CurrentMagType>(buffer, start_idx, num_samples);
+                    this->current_pos_ += static_cast<double>(num_samples);
+                    break;
+                }
+            }
+        }
+
+        template<MagType CurrentMagType>
+        void processChunk(std::span<FloatType *> buffer, const size_t start_idx, const size_t num_samples) {
+            for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                octave_pointers_[0][chan] = buffer[chan] + start_idx;
+            }
+            auto octave_num_samples = num_samples;
+            for (size_t k = 0; k < OctaveNum; ++k) {
+                if (octave_num_samples > 0) {
+                    filterBands(k, octave_num_samples);
+                    updateMags<CurrentMagType>(k, octave_num_samples);
+                }
+                if (k + 1 < OctaveNum) {
+                    octave_num_samples = decimate(k, octave_num_samples);
+                }
+            }
+        }
+
+        /**
+         * decimate octave k into octave k + 1, an odd sample is kept for the next call
+         * @return the number of samples of octave k + 1
+         */
+        size_t decimate(const size_t k, const size_t num_samples) {
+            auto &stage{stages_[k]};
+            auto &os_buffers{stage.getOSBuffer()};
+            const auto carry = carries_[k + 1];
+            const auto total = carry + num_samples;
+            for (size_t chan = 0; chan < os_buffers.size(); ++chan) {
+                std::copy(octave_pointers_[k][chan], octave_pointers_[k][chan] + num_samples,
+                          os_buffers[chan].begin() + static_cast<std::ptrdiff_t>(carry));
+            }
+            const auto down_num_samples = total >> 1;
+            if (down_num_samples > 0) {
+                stage.downsample(octave_pointers_[k + 1], down_num_samples);
+            }
+            carries_[k + 1] = total & 1;
+            if (carries_[k + 1] == 1) {
+                for (auto &os_buffer: os_buffers) {
+                    os_buffer[0] = os_buffer[total - 1];
+                }
+            }
+            return down_num_samples;
+        }
+
+        /**
+         * run the band filters of octave k into band_frames_, the inner loops run across the bands
+         */
+        void filterBands(const size_t k, const size_t num_samples) {
+            for (size_t chan = 0; chan < band_frames_.size(); ++chan) {
+                const auto *input = octave_pointers_[k][chan];
+                auto *frames = band_frames_[chan].data();
+                auto &states{band_states_[k][chan]};
+                for (size_t i = 0; i < num_samples; ++i) {
+                    auto *frame = frames + i * BandsPerOctave;
+                    std::fill(frame, frame + BandsPerOctave, input[i]);
+                    for (size_t s = 0; s < kSectionNum; ++s) {
+                        const auto &c{band_coeffs_[s]};
+                        auto &state{states[s]};
+                        for (size_t j = 0; j < BandsPerOctave; ++j) {
+                            const auto x = frame[j];
+                            const auto y = x * c[0][j] + state.s1[j];
+                            state.s1[j] = x * c[1][j] - y * c[3][j] + state.s2[j];
+                            state.s2[j] = x * c[2][j] - y * c[4][j];
+                            frame[j] = y;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * accumulate the levels of the bands of octave k from band_frames_, the inner loops run across the bands
+         */
+        template<MagType CurrentMagType>
+        void updateMags(const size_t k, const size_t num_samples) {
+            const auto first_band = (OctaveNum - 1 - k) * BandsPerOctave;
+            for (size_t chan = 0; chan < band_frames_.size(); ++chan) {
+                const auto *frames = band_frames_[chan].data();
+                std::array<FloatType, BandsPerOctave> min_v{}, max_v{}, sumsqr_v{};
+                if (CurrentMagType == MagType::kStats) {
+                    for (size_t j = 0; j < BandsPerOctave; ++j) {
+                        min_v[j] = this->current_stats_[first_band + j][0];
+                        max_v[j] = this->current_stats_[first_band + j][1];
+                    }
+                }
+                for (size_t i = 0; i < num_samples; ++i) {
+                    const auto *frame = frames + i * BandsPerOctave;
+                    for (size_t j = 0; j < BandsPerOctave; ++j) {
+                        const auto x = frame[j];
+                        switch (CurrentMagType) {
+                            case MagType::kPeak: {
+                                max_v[j] = std::max(max_v[j], std::abs(x));
+                                break;
+                            }
+                            case MagType::kRMS: {
+                                sumsqr_v[j] += x * x;
+                                break;
+                            }
+                            case MagType::kStats: {
+                                min_v[j] = std::min(min_v[j], x);
+                                max_v[j] = std::max(max_v[j], x);
+                                sumsqr_v[j] += x * x;
+                                break;
+                            }
+                        }
+                    }
+                }
+                for (size_t j = 0; j < BandsPerOctave; ++j) {
+                    const auto band = first_band + j;
+                    switch (CurrentMagType) {
+                        case MagType::kPeak: {
+                            this->current_mags_[band] = std::max(this->current_mags_[band], max_v[j]);
+                            break;
+                        }
+                        case MagType::kRMS: {
+                            this->current_mags_[band] += sumsqr_v[j];
+                            break;
+                        }
+                        case MagType::kStats: {
+                            auto &stats{this->current_stats_[band]};
+                            stats = {min_v[j], max_v[j], stats[2] + sumsqr_v[j]};
+                            this->current_stats_num_samples_[band] += num_samples;
+                            break;
+                        }
+                    }
+                    band_num_samples_[band] += num_samples;
+                }
+            }
+        }
+
+        template<MagType CurrentMagType>
+        void pushMags() {
+            const auto to_write = this->abstract_fifo_.planWrite(1).num_to_write > 0;
+            size_t write_idx = 0;
+            if (to_write) {
+                const auto range = this->abstract_fifo_.prepareToWrite(1);
+                write_idx = static_cast<size_t>(range.block_size1 > 0 ? range.start_index1 : range.start_index2);
+            }
+            for (size_t band = 0; band < kBandNum; ++band) {
+                // the lowest octaves may not receive a sample within a short segment, keep the last level
+                if (band_num_samples_[band] == 0) {
+                    if (to_write) {
+                        this->mag_fifos_[band][write_idx] = last_dbs_[band];
+                        if (CurrentMagType == MagType::kStats) {
+                            this->stats_fifos_[band][write_idx] = last_stats_[band];
+                        }
+                    }
+                    continue;
+                }
+                switch (CurrentMagType) {
+                    case MagType::kPeak: {
+                        last_dbs_[band] = zldsp::chore::gainToDecibels(static_cast<float>(this->current_mags_[band]));
+                        break;
+                    }
+                    case MagType::kRMS: {
+                        last_dbs_[band] = 0.5f * zldsp::chore::gainToDecibels(static_cast<float>(
+                                              this->current_mags_[band] /
+                                              static_cast<FloatType>(band_num_samples_[band])));
+                        break;
+                    }
+                    case MagType::kStats: {
+                        last_stats_[band] = this->popStats(band);
+                        last_dbs_[band] = last_stats_[band].rms_db;
+                        if (to_write) {
+                            this->stats_fifos_[band][write_idx] = last_stats_[band];
+                        }
+                        break;
+                    }
+                }
+                if (to_write) {
+                    this->mag_fifos_[band][write_idx] = last_dbs_[band];
+                }
+                this->current_mags_[band] = FloatType(0);
+                band_num_samples_[band] = 0;
+            }
+            if (to_write) {
+                this->abstract_fifo_.finishWrite(1);
+            }
+        }
+    };
+}
@@ -9,8 +9,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <vector>
+
 #include "over_sample_stage.hpp"
 #include "halfband_coeffs.hpp"
+#include "../chore/realtime_check.hpp"
+#include "../chore/cycle_counter.hpp"
 
 namespace zldsp::oversample {
     /**
@@ -20,6 +27,11 @@ namespace zldsp::oversample {
      */
     template<typename FloatType, size_t NumStage>
     class OverSampler {
+    public:
+        // the size (in bytes) of all stage buffers, about a typical L2 cache
+        static constexpr size_t kCacheBudget = static_cast<size_t>(1) << 18;
+        static constexpr size_t kMinSubBlockSize = 32;
+
     private:
         static constexpr std::array kCoeff_128_05_100 = halfband_coeff::convert<FloatType>(
             halfband_coeff::kCoeff_128_05_100);
@@ -45,14 +57,40 @@ namespace zldsp::oversample {
             }
         }
 
+        /**
+         * call before processing starts, not real-time safe
+         * the stage buffers hold num_samples, process still works in cache-sized sub-blocks
+         * @param num_channels
+         * @param num_samples the maximum number of samples per upsample / downsample call
+         */
         void prepare(const size_t num_channels, const size_t num_samples) {
-            auto stage_num_samples = num_samples;
-            for (size_t i = 0; i < NumStage; ++i) {
-                stages_[i].prepare(num_channels, stage_num_samples);
-                stage_num_samples = stage_num_samples << 1;
-            }
+            const auto cache_block_size = getCacheBlockSize(num_channels);
+            allocate(num_channels, std::max(num_samples, static_cast<size_t>(1)));
+            sub_block_size_ = std::min(max_num_samples_, cache_block_size);
         }
 
+        /**
+         * call before processing starts, not real-time safe
+         * the stage buffers only hold one sub-block whose size keeps all of them within kCacheBudget,
+         * so the memory does not depend on the host block size
+         * process accepts any number of samples, upsample / downsample at most getMaxNumSamples()
+         * @param num_channels
+         */
+        void prepareBounded(const size_t num_channels) {
+            allocate(num_channels, getCacheBlockSize(num_channels));
+            sub_block_size_ = max_num_samples_;
+        }
+
+        /**
+         * @return the maximum number of samples of upsample / downsample
+         */
+        [[nodiscard]] size_t getMaxNumSamples() const { return max_num_samples_; }
+
+        /**
+         * @return the number of samples per sub-block of process
+         */
+        [[nodiscard]] size_t getSubBlockSize() const { return sub_block_size_; }
+
         /**
          * reset the internal oversampling states
          */
@@ -73,9 +111,12 @@ namespace zldsp::oversample {
         /**
          * process samples up
          * @param buffer input samples
-         * @param num_samples
+         * @param num_samples must not exceed getMaxNumSamples(), use process for larger blocks
          */
         void upsample(std::span<FloatType *> buffer, const size_t num_samples) {
+            assert(num_samples <= max_num_samples_);
+            ZLDSP_REALTIME_SCOPE("zldsp::oversample::OverSampler::upsample");
+            ZLDSP_CYCLE_COUNTER(upsample_counter_, num_samples);
             auto stage_num_sample = num_samples;
             stages_[0].template upsample<true>(buffer, stage_num_sample);
             for (size_t i = 1; i < NumStage; ++i) {
@@ -87,9 +128,12 @@ namespace zldsp::oversample {
         /**
          * process samples down
          * @param buffer output samples
-         * @param num_samples
+         * @param num_samples must not exceed getMaxNumSamples(), use process for larger blocks
          */
         void downsample(std::span<FloatType *> buffer, const size_t num_samples) {
+            assert(num_samples <= max_num_samples_);
+            ZLDSP_REALTIME_SCOPE("zldsp::oversample::OverSampler::downsample");
+            ZLDSP_CYCLE_COUNTER(downsample_counter_, num_samples);
             auto stage_num_sample = num_samples << (NumStage - 1);
             for (size_t i = NumStage - 1; i > 0; --i) {
                 stages_[i].template downsample<false>(stages_[i - 1].getOSPointer(), stage_num_sample);
@@ -98,6 +142,30 @@ namespace zldsp::oversample {
             stages_[0].template downsample<true>(buffer, num_samples);
         }
 
+        /**
+         * upsample, call func on the over-sampled buffer and downsample, in sub-blocks of getSubBlockSize()
+         * so that the over-sampled data stays in the cache, and any block size is accepted
+         * @param buffer input and output samples
+         * @param num_samples any number of samples
+         * @param func called as func(std::span<FloatType *> os_buffer, size_t os_num_samples)
+         */
+        template<typename Func>
+        void process(std::span<FloatType *> buffer, const size_t num_samples, Func &&func) {
+            ZLDSP_REALTIME_SCOPE("zldsp::oversample::OverSampler::process");
+            ZLDSP_CYCLE_COUNTER(process_counter_, num_samples);
+            const auto num_channels = std::min(buffer.size(), sub_pointers_.size());
+            for (size_t start = 0; start < num_samples; start += sub_block_size_) {
+                const auto num = std::min(num_samples - start, sub_block_size_);
+                for (size_t chan = 0; chan < num_channels; ++chan) {
+                    sub_pointers_[chan] = buffer[chan] + start;
+                }
+                const auto sub_buffer = std::span<FloatType *>(sub_pointers_.data(), num_channels);
+                upsample(sub_buffer, num);
+                func(std::span<FloatType *>(getOSPointer().data(), num_channels), num << NumStage);
+                downsample(sub_buffer, num);
+            }
+        }
+
         /**
          * @return the internal over-sampled buffer
          */
@@ -114,5 +182,36 @@ namespace zldsp::oversample {
 
     private:
         std::vector<OverSampleStage<FloatType> > stages_;
+        size_t max_num_samples_{0}, sub_block_size_{1};
+        std::vector<FloatType *> sub_pointers_;
+        chore::CycleCounter upsample_counter_, downsample_counter_, process_counter_;
+
+        /**
+         * @param num_channels
+         * @return the largest power-of-two block whose stage buffers fit into kCacheBudget
+         */
+        static size_t getCacheBlockSize(const size_t num_channels) {
+            // bytes of all stage buffers per input sample
+            const auto bytes_per_sample = std::max(num_channels, static_cast<size_t>(1)) * sizeof(FloatType) *
+                                          ((static_cast<size_t>(2) << NumStage) - 2);
+            size_t cache_block_size = kMinSubBlockSize;
+            while ((cache_block_size << 1) * bytes_per_sample <= kCacheBudget) {
+                cache_block_size <<= 1;
+            }
+            return cache_block_size;
+        }
+
+        void allocate(const size_t num_channels, const size_t num_samples) {
+            upsample_counter_.prepare("zldsp::oversample::OverSampler::upsample", this);
+            downsample_counter_.prepare("zldsp::oversample::OverSampler::downsample", this);
+            process_counter_.prepare("zldsp::oversample::OverSampler::process", this);
+            max_num_samples_ = num_samples;
+            auto stage_num_samples = num_samples;
+            for (size_t i = 0; i < NumStage; ++i) {
+                stages_[i].prepare(num_channels, stage_num_samples);
+                stage_num_samples = stage_num_samples << 1;
+            }
+            sub_pointers_.resize(num_channels);
+        }
     };
 }
@@ -43,6 +43,31 @@ namespace zldsp::splitter {
             r_vector = l_vector - kSqrt2 * r_vector;
         }
 
+        /**
+         * switch the left/right channels of an interleaved buffer to mid/side in place
+         * @param buffer num_samples frames of num_channels samples, the first two channels are left and right
+         * @param num_channels at least 2
+         * @param num_samples the number of frames
+         */
+        static constexpr void splitInterleaved(FloatType *buffer, const size_t num_channels, const size_t num_samples) {
+            for (size_t i = 0; i < num_samples; ++i) {
+                auto *frame = buffer + i * num_channels;
+                const auto l = frame[0], r = frame[1];
+                frame[0] = kSqrt2Over2 * (l + r);
+                frame[1] = kSqrt2Over2 * (l - r);
+            }
+        }
+
+        /**
+         * switch the mid/side channels of an interleaved buffer to left/right in place
+         * @param buffer num_samples frames of num_channels samples, the first two channels are mid and side
+         * @param num_channels at least 2
+         * @param num_samples the number of frames
+         */
+        static constexpr void combineInterleaved(FloatType *buffer, const size_t num_channels, const size_t num_samples) {
+            splitInterleaved(buffer, num_channels, num_samples);
+        }
+
     private:
         static constexpr FloatType kSqrt2Over2 = static_cast<FloatType>(
             0.7071067811865475244008443621048490392848359376884740365883398690);
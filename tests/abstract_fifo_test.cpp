@@ -0,0 +1,194 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "container/abstract_fifo.hpp"
+
+using zldsp::container::AbstractFIFO;
+using zldsp::container::OverflowPolicy;
+
+namespace {
+    /**
+     * a FIFO of ints, which writes and reads whole blocks the way the analyzers do
+     */
+    class IntFIFO {
+    public:
+        explicit IntFIFO(const int capacity) : fifo(capacity), data_(static_cast<size_t>(capacity)) {
+        }
+
+        /**
+         * write the consecutive values [start, start + num) under the overflow policy
+         */
+        AbstractFIFO::WritePlan write(const int start, const int num) {
+            const auto plan = fifo.planWrite(num);
+            const auto range = fifo.prepareToWrite(plan.num_to_write);
+            int value = start + plan.offset;
+            for (int k = 0; k < range.block_size1 + range.block_size2; ++k) {
+                const auto idx = k < range.block_size1
+                                     ? range.start_index1 + k
+                                     : range.start_index2 + k - range.block_size1;
+                data_[static_cast<size_t>(idx)] = value;
+                value += plan.step;
+            }
+            fifo.finishWrite(plan.num_to_write);
+            return plan;
+        }
+
+        std::vector<int> read(const int num) {
+            const auto range = fifo.prepareToRead(num);
+            std::vector<int> values;
+            for (int k = 0; k < range.block_size1; ++k) {
+                values.push_back(data_[static_cast<size_t>(range.start_index1 + k)]);
+            }
+            for (int k = 0; k < range.block_size2; ++k) {
+                values.push_back(data_[static_cast<size_t>(range.start_index2 + k)]);
+            }
+            fifo.finishRead(num);
+            return values;
+        }
+
+        std::vector<int> readAll() {
+            return read(fifo.getNumReady());
+        }
+
+        AbstractFIFO fifo;
+
+    private:
+        std::vector<int> data_;
+    };
+
+    std::vector<int> iota(const int start, const int num) {
+        std::vector<int> values(static_cast<size_t>(num));
+        std::iota(values.begin(), values.end(), start);
+        return values;
+    }
+}
+
+TEST(AbstractFIFOTest, EveryPolicyWritesABlockThatFillsTheCapacity) {
+    for (const auto policy: {OverflowPolicy::kDropNewest, OverflowPolicy::kOverwriteOldest,
+                             OverflowPolicy::kDecimate}) {
+        IntFIFO f{16};
+        f.fifo.setOverflowPolicy(policy);
+        // one slot stays empty, so 15 elements fit
+        f.write(0, 6);
+        f.read(4);
+        const auto plan = f.write(6, 13);
+        EXPECT_EQ(plan.num_to_write, 13);
+        EXPECT_EQ(plan.offset, 0);
+        EXPECT_EQ(plan.step, 1);
+        EXPECT_EQ(f.fifo.getNumFree(), 0);
+        EXPECT_EQ(f.fifo.applyResync(), 0);
+        EXPECT_EQ(f.fifo.getDroppedCount(), 0u);
+        EXPECT_EQ(f.fifo.getHighWater(), 15);
+        EXPECT_EQ(f.readAll(), iota(4, 15));
+    }
+}
+
+TEST(AbstractFIFOTest, DropNewestKeepsTheHeadOfTheBlock) {
+    IntFIFO f{16};
+    f.write(0, 10);
+    const auto plan = f.write(10, 8);
+    EXPECT_EQ(plan.num_to_write, 5);
+    EXPECT_EQ(plan.offset, 0);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 3u);
+    EXPECT_EQ(f.fifo.getHighWater(), 15);
+    // nothing fits into a full FIFO
+    EXPECT_EQ(f.write(18, 4).num_to_write, 0);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 7u);
+    EXPECT_EQ(f.fifo.applyResync(), 0);
+    EXPECT_EQ(f.readAll(), iota(0, 15));
+}
+
+TEST(AbstractFIFOTest, OverwriteOldestKeepsTheTailOfTheBlockAndResyncs) {
+    IntFIFO f{16};
+    f.fifo.setOverflowPolicy(OverflowPolicy::kOverwriteOldest);
+    // move the head so that the resync position wraps around the buffer
+    f.write(0, 12);
+    f.read(12);
+    f.write(100, 10);
+    const auto plan = f.write(110, 8);
+    EXPECT_EQ(plan.num_to_write, 5);
+    EXPECT_EQ(plan.offset, 3);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 3u);
+    EXPECT_EQ(f.fifo.getHighWater(), 15);
+    // the consumer discards the oldest 8 elements of the backlog, so that the next block fits
+    EXPECT_EQ(f.fifo.applyResync(), 8);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 11u);
+    EXPECT_EQ(f.fifo.applyResync(), 0);
+    EXPECT_EQ(f.fifo.getNumReady(), 7);
+    EXPECT_EQ(f.write(118, 8).num_to_write, 8);
+    std::vector<int> expected{108, 109, 113, 114, 115, 116, 117};
+    const auto next = iota(118, 8);
+    expected.insert(expected.end(), next.begin(), next.end());
+    EXPECT_EQ(f.readAll(), expected);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 11u);
+}
+
+TEST(AbstractFIFOTest, OverwriteOldestIntoAFullFIFODiscardsTheBlockSize) {
+    IntFIFO f{16};
+    f.fifo.setOverflowPolicy(OverflowPolicy::kOverwriteOldest);
+    f.write(0, 15);
+    const auto plan = f.write(15, 4);
+    EXPECT_EQ(plan.num_to_write, 0);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 4u);
+    EXPECT_EQ(f.fifo.applyResync(), 4);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 8u);
+    EXPECT_EQ(f.readAll(), iota(4, 11));
+}
+
+TEST(AbstractFIFOTest, OverwriteOldestSkipsAResyncTheConsumerHasReadPast) {
+    IntFIFO f{16};
+    f.fifo.setOverflowPolicy(OverflowPolicy::kOverwriteOldest);
+    f.write(0, 10);
+    f.write(10, 8);
+    // the consumer drains the FIFO before it applies the resync
+    EXPECT_EQ(f.read(10), iota(0, 10));
+    EXPECT_EQ(f.fifo.applyResync(), 0);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 3u);
+    EXPECT_EQ(f.readAll(), iota(13, 5));
+}
+
+TEST(AbstractFIFOTest, DecimateThinsOutTheBlock) {
+    IntFIFO f{16};
+    f.fifo.setOverflowPolicy(OverflowPolicy::kDecimate);
+    f.write(0, 10);
+    const auto plan = f.write(10, 12);
+    EXPECT_EQ(plan.step, 3);
+    EXPECT_EQ(plan.num_to_write, 4);
+    EXPECT_EQ(plan.offset, 0);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 8u);
+    EXPECT_EQ(f.fifo.getHighWater(), 14);
+    // nothing fits into a full FIFO
+    f.write(100, 1);
+    EXPECT_EQ(f.write(101, 5).num_to_write, 0);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 13u);
+    EXPECT_EQ(f.fifo.getHighWater(), 15);
+    auto expected = iota(0, 10);
+    expected.insert(expected.end(), {10, 13, 16, 19, 100});
+    EXPECT_EQ(f.readAll(), expected);
+}
+
+TEST(AbstractFIFOTest, ResetStatsClearsTheCounters) {
+    IntFIFO f{8};
+    f.write(0, 10);
+    EXPECT_EQ(f.fifo.getDroppedCount(), 3u);
+    EXPECT_EQ(f.fifo.getHighWater(), 7);
+    f.fifo.resetStats();
+    EXPECT_EQ(f.fifo.getDroppedCount(), 0u);
+    EXPECT_EQ(f.fifo.getHighWater(), 0);
+    f.read(5);
+    f.write(10, 1);
+    EXPECT_EQ(f.fifo.getHighWater(), 3);
+}
@@ -0,0 +1,223 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "vector/vector.hpp"
+#include "container/broadcast_ring.hpp"
+#include "mag_analyzer/mag_analyzer.hpp"
+
+using zldsp::container::BroadcastReaderGroup;
+using zldsp::container::BroadcastRing;
+
+namespace {
+    /**
+     * write samples [start, start + num) of a ramp to every channel of the ring
+     */
+    void writeRamp(BroadcastRing<double> &ring, const std::uint64_t start, const size_t num) {
+        std::vector<std::vector<double> > data(ring.getNumChannels(), std::vector<double>(num));
+        std::vector<double *> pointers;
+        for (auto &channel: data) {
+            for (size_t i = 0; i < num; ++i) {
+                channel[i] = static_cast<double>(start + i);
+            }
+            pointers.push_back(channel.data());
+        }
+        ring.write(std::span<double *>(pointers), num);
+    }
+}
+
+TEST(BroadcastRingTest, ReadsBlocksAcrossTheWrap) {
+    BroadcastRing<double> ring;
+    ring.prepare(2, 6);
+    EXPECT_EQ(ring.getCapacity(), 8);
+    BroadcastRing<double>::Reader reader{ring};
+    std::array<std::vector<double>, 2> output{std::vector<double>(8), std::vector<double>(8)};
+    std::array<double *, 2> pointers{output[0].data(), output[1].data()};
+    std::uint64_t position = 0;
+    for (int block = 0; block < 10; ++block) {
+        writeRamp(ring, position, 3);
+        ASSERT_EQ(reader.read(pointers, 8), 3);
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(output[0][i], static_cast<double>(position + i));
+            EXPECT_EQ(output[1][i], static_cast<double>(position + i));
+        }
+        position += 3;
+        EXPECT_EQ(reader.getPosition(), position);
+    }
+    EXPECT_EQ(reader.getOverrunCount(), 0);
+}
+
+TEST(BroadcastRingTest, OverrunSkipsToTheNewestSample) {
+    BroadcastRing<double> ring;
+    ring.prepare(1, 8);
+    BroadcastRing<double>::Reader slow_reader{ring}, fast_reader{ring};
+    std::vector<double> output(8);
+    std::array<double *, 1> pointers{output.data()};
+    for (std::uint64_t position = 0; position < 20; position += 4) {
+        writeRamp(ring, position, 4);
+        ASSERT_EQ(fast_reader.read(pointers, 8), 4);
+    }
+    // the slow reader is 20 samples behind a ring of 8
+    EXPECT_EQ(slow_reader.getNumReady(), 8);
+    EXPECT_EQ(slow_reader.read(pointers, 8), 0);
+    EXPECT_EQ(slow_reader.getOverrunCount(), 1);
+    EXPECT_EQ(slow_reader.getDroppedCount(), 20);
+    EXPECT_EQ(slow_reader.getPosition(), 20);
+    // both readers continue with the next block
+    writeRamp(ring, 20, 4);
+    ASSERT_EQ(slow_reader.read(pointers, 8), 4);
+    EXPECT_EQ(output[0], 20.0);
+    EXPECT_EQ(output[3], 23.0);
+    EXPECT_EQ(fast_reader.read(pointers, 8), 4);
+    EXPECT_EQ(fast_reader.getOverrunCount(), 0);
+}
+
+TEST(BroadcastRingTest, ConcurrentReadsNeverReturnOverwrittenSamples) {
+    // the writer laps the reader during its copies, every returned sample must still be the one at its position
+    constexpr size_t kCapacity = 256, kWriteSize = 64;
+    constexpr std::uint64_t kNumSamples = 1 << 17;
+    BroadcastRing<double> ring;
+    ring.prepare(1, kCapacity);
+    BroadcastRing<double>::Reader reader{ring};
+    std::atomic<bool> is_done{false};
+    std::thread writer([&]() {
+        for (std::uint64_t position = 0; position < kNumSamples; position += kWriteSize) {
+            writeRamp(ring, position, kWriteSize);
+            // give the reader a chance on machines with few cores, it is still lapped from time to time
+            std::this_thread::yield();
+        }
+        is_done.store(true, std::memory_order::release);
+    });
+    std::vector<double> output(kCapacity);
+    std::array<double *, 1> pointers{output.data()};
+    std::uint64_t num_read = 0, num_mismatch = 0;
+    while (!is_done.load(std::memory_order::acquire) || reader.getNumReady() > 0) {
+        const auto position = reader.getPosition();
+        const auto num = reader.read(pointers, kCapacity);
+        for (size_t i = 0; i < num; ++i) {
+            num_mismatch += output[i] != static_cast<double>(position + i) ? 1 : 0;
+        }
+        num_read += num;
+    }
+    writer.join();
+    EXPECT_EQ(num_mismatch, 0);
+    EXPECT_GT(num_read, 0);
+    EXPECT_EQ(num_read + reader.getDroppedCount(), kNumSamples);
+}
+
+TEST(BroadcastReaderGroupTest, OverrunRealignsAllReaders) {
+    std::array<BroadcastRing<double>, 2> rings;
+    for (auto &ring: rings) {
+        ring.prepare(1, 8);
+    }
+    BroadcastRing<double>::Reader reader0{rings[0]}, reader1{rings[1]};
+    BroadcastReaderGroup<double, 2> group;
+    group.prepare({&reader0, &reader1}, 4);
+
+    writeRamp(rings[0], 0, 6);
+    writeRamp(rings[1], 0, 6);
+    ASSERT_EQ(group.read(), 4);
+    EXPECT_EQ(group.getBuffer(1)[0][3], 3.0);
+    // the second ring runs ahead and overruns its reader
+    writeRamp(rings[0], 6, 2);
+    writeRamp(rings[1], 6, 10);
+    EXPECT_EQ(group.read(), 0);
+    EXPECT_EQ(group.popNumSkipped(), 4);
+    EXPECT_EQ(group.popNumSkipped(), 0);
+    writeRamp(rings[0], 8, 4);
+    writeRamp(rings[1], 16, 4);
+    ASSERT_EQ(group.read(), 4);
+    EXPECT_EQ(group.getBuffer(0)[0][0], 8.0);
+    EXPECT_EQ(group.getBuffer(1)[0][0], 16.0);
+}
+
+TEST(BroadcastReaderGroupTest, MagAnalyzerPullMatchesProcess) {
+    constexpr size_t kPointNum = 40, kBlockSize = 128;
+    zldsp::analyzer::MultipleMagAnalyzer<double, 2, kPointNum> direct, pulled;
+    for (auto *analyzer: {&direct, &pulled}) {
+        analyzer->setTimeLength(.5f);
+        analyzer->prepare(48000.0);
+    }
+    std::array<BroadcastRing<double>, 2> rings;
+    for (auto &ring: rings) {
+        ring.prepare(2, 4 * kBlockSize);
+    }
+    BroadcastRing<double>::Reader reader0{rings[0]}, reader1{rings[1]};
+    BroadcastReaderGroup<double, 2> group;
+    group.prepare({&reader0, &reader1}, kBlockSize);
+
+    std::array<std::vector<double>, 4> data;
+    for (auto &channel: data) {
+        channel.resize(kBlockSize);
+    }
+    std::array<double *, 2> pre{data[0].data(), data[1].data()}, post{data[2].data(), data[3].data()};
+    for (size_t block = 0; block < 200; ++block) {
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            const auto t = static_cast<double>(block * kBlockSize + i);
+            data[0][i] = std::sin(t * .01) * .5;
+            data[1][i] = std::sin(t * .02) * .25;
+            data[2][i] = data[0][i] * static_cast<double>(block % 7) * .1;
+            data[3][i] = data[1][i] * .5;
+        }
+        direct.process({std::span<double *>(pre), std::span<double *>(post)}, kBlockSize);
+        rings[0].write(pre, kBlockSize);
+        rings[1].write(post, kBlockSize);
+        pulled.pull(group);
+        EXPECT_EQ(direct.run(), pulled.run());
+    }
+
+    std::array<float, kPointNum> xs{}, direct_pre{}, direct_post{}, pulled_pre{}, pulled_post{};
+    direct.createPath(xs, {std::span<float>(direct_pre), std::span<float>(direct_post)}, 100.f, 100.f);
+    pulled.createPath(xs, {std::span<float>(pulled_pre), std::span<float>(pulled_post)}, 100.f, 100.f);
+    EXPECT_EQ(direct_pre, pulled_pre);
+    EXPECT_EQ(direct_post, pulled_post);
+}
+
+TEST(BroadcastReaderGroupTest, OctaveAnalyzerPullMatchesProcess) {
+    constexpr size_t kPointNum = 40, kBlockSize = 128;
+    zldsp::analyzer::OctaveAnalyzer<double, 1, 3, kPointNum> direct, pulled;
+    for (auto *analyzer: {&direct, &pulled}) {
+        analyzer->setTimeLength(.5f);
+        analyzer->prepare(48000.0, 1, kBlockSize);
+    }
+    BroadcastRing<double> ring;
+    ring.prepare(1, 4 * kBlockSize);
+    BroadcastRing<double>::Reader reader{ring};
+    BroadcastReaderGroup<double, 1> group;
+    group.prepare({&reader}, kBlockSize);
+
+    std::vector<double> data(kBlockSize);
+    std::array<double *, 1> pointers{data.data()};
+    for (size_t block = 0; block < 200; ++block) {
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            const auto t = static_cast<double>(block * kBlockSize + i);
+            data[i] = std::sin(t * .3) * .5 + std::sin(t * .05) * static_cast<double>(block % 7) * .1;
+        }
+        ring.write(pointers, kBlockSize);
+        direct.process(pointers, kBlockSize);
+        pulled.pull(group);
+        EXPECT_EQ(direct.run(), pulled.run());
+    }
+
+    std::array<float, kPointNum> xs{};
+    std::array<std::array<float, kPointNum>, 3> direct_ys{}, pulled_ys{};
+    direct.createPath(xs, {std::span<float>(direct_ys[0]), std::span<float>(direct_ys[1]),
+                           std::span<float>(direct_ys[2])}, 100.f, 100.f);
+    pulled.createPath(xs, {std::span<float>(pulled_ys[0]), std::span<float>(pulled_ys[1]),
+                           std::span<float>(pulled_ys[2])}, 100.f, 100.f);
+    EXPECT_EQ(direct_ys, pulled_ys);
+}
@@ -0,0 +1,54 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include "fft/constant_q_transform.hpp"
+
+using zldsp::fft::ConstantQTransform;
+
+TEST(ConstantQTransformTest, LowFrequenciesKeepTheirQ) {
+    constexpr double kSampleRate = 48000.0, kQ = 34.0;
+    // a window of Q periods at 40 Hz is ten times the FFT size, so it is evaluated in a decimated octave
+    const std::vector<float> freqs{40.f, 46.f, 1000.f, 1150.f};
+    ConstantQTransform<float> cqt;
+    cqt.prepare(12, kSampleRate, freqs, kQ);
+    EXPECT_EQ(cqt.getNumFrequencies(), freqs.size());
+    EXPECT_GT(cqt.getNumOctaves(), 4u);
+
+    std::vector<float> magnitudes(freqs.size());
+    const auto measure = [&](const double freq) {
+        cqt.reset();
+        std::vector<float> block(512);
+        size_t n = 0;
+        for (size_t i = 0; i < 300; ++i) {
+            for (auto &x: block) {
+                x = static_cast<float>(std::sin(2.0 * std::numbers::pi * freq * static_cast<double>(n) / kSampleRate));
+                n += 1;
+            }
+            cqt.process(block.data(), block.size());
+        }
+        cqt.forwardMagnitude(magnitudes);
+    };
+
+    // a full-scale sine gives 1/4 at its own frequency, and the neighbour a few bandwidths away rejects it
+    measure(40.0);
+    EXPECT_NEAR(magnitudes[0], .25f, .01f);
+    EXPECT_LT(magnitudes[1], .25f * .03f);
+    measure(1000.0);
+    EXPECT_NEAR(magnitudes[2], .25f, .01f);
+    EXPECT_LT(magnitudes[3], .25f * .03f);
+    EXPECT_LT(magnitudes[0], .25f * .03f);
+}
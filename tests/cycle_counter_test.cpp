@@ -0,0 +1,108 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "chore/cycle_counter.hpp"
+#include "gain/gain.hpp"
+
+using zldsp::chore::CycleCounter;
+using zldsp::chore::CycleCounterRegistry;
+using zldsp::chore::CycleHistogram;
+
+namespace {
+    const CycleHistogram *findHistogram(const void *owner, const char *name) {
+        const auto &registry = CycleCounterRegistry::getInstance();
+        for (size_t idx = 0; idx < registry.size(); ++idx) {
+            const auto *histogram = registry.get(idx);
+            if (histogram != nullptr && histogram->getOwner() == owner
+                && std::string_view(histogram->getName()) == name) {
+                return histogram;
+            }
+        }
+        return nullptr;
+    }
+}
+
+TEST(CycleCounterTest, ExtractsPercentilesAndMax) {
+    CycleHistogram histogram;
+    constexpr size_t kBlockSize = 512;
+    for (size_t i = 0; i < 985; ++i) histogram.record(kBlockSize, 1000);
+    for (size_t i = 0; i < 10; ++i) histogram.record(kBlockSize, 100000);
+    for (size_t i = 0; i < 5; ++i) histogram.record(kBlockSize, 1000000);
+
+    const auto block_class = CycleHistogram::getBlockClass(kBlockSize);
+    EXPECT_EQ(block_class, 9);
+    const auto stats = histogram.getStats(block_class);
+    EXPECT_EQ(stats.count, 1000);
+    // p50 / p99 are the upper bounds of their buckets, which are a quarter octave wide
+    EXPECT_GE(stats.p50, 1000);
+    EXPECT_LE(stats.p50, 1250);
+    EXPECT_GE(stats.p99, 100000);
+    EXPECT_LE(stats.p99, 125000);
+    EXPECT_EQ(stats.max, 1000000);
+    // other block sizes are kept apart
+    EXPECT_EQ(histogram.getStats(block_class + 1).count, 0);
+    histogram.record(kBlockSize * 2, 10);
+    EXPECT_EQ(histogram.getStats(block_class + 1).max, 10);
+
+    histogram.clear();
+    EXPECT_EQ(histogram.getStats(block_class).count, 0);
+    EXPECT_EQ(histogram.getStats(block_class).max, 0);
+}
+
+TEST(CycleCounterTest, RecordsPerInstance) {
+    constexpr size_t kNumSamples = 256;
+    std::vector<float> data(kNumSamples, 1.f);
+    std::vector<float *> pointers{data.data()};
+
+    zldsp::gain::Gain<float> gain0, gain1;
+    // nothing is registered before prepare
+    EXPECT_EQ(findHistogram(&gain0, "zldsp::gain::Gain::process"), nullptr);
+    gain0.prepare(48000.0, kNumSamples, 0.01);
+    gain1.prepare(48000.0, kNumSamples, 0.01);
+    const auto *histogram0 = findHistogram(&gain0, "zldsp::gain::Gain::process");
+    const auto *histogram1 = findHistogram(&gain1, "zldsp::gain::Gain::process");
+    ASSERT_NE(histogram0, nullptr);
+    ASSERT_NE(histogram1, nullptr);
+    EXPECT_NE(histogram0, histogram1);
+    // a second prepare keeps the histogram
+    gain0.prepare(48000.0, kNumSamples, 0.01);
+    EXPECT_EQ(findHistogram(&gain0, "zldsp::gain::Gain::process"), histogram0);
+
+    for (size_t i = 0; i < 3; ++i) {
+        gain0.process(pointers, kNumSamples);
+    }
+    const auto block_class = CycleHistogram::getBlockClass(kNumSamples);
+    EXPECT_EQ(histogram0->getStats(block_class).count, 3);
+    EXPECT_EQ(histogram1->getStats(block_class).count, 0);
+}
+
+TEST(CycleCounterTest, ReleasesOnDestruction) {
+    const void *owner = nullptr; {
+        zldsp::gain::Gain<float> gain;
+        gain.prepare(48000.0, 64, 0.01);
+        owner = &gain;
+        ASSERT_NE(findHistogram(owner, "zldsp::gain::Gain::process"), nullptr);
+        // a copy is not registered until it is prepared
+        const auto copy = gain;
+        EXPECT_EQ(findHistogram(&copy, "zldsp::gain::Gain::process"), nullptr);
+    }
+    EXPECT_EQ(findHistogram(owner, "zldsp::gain::Gain::process"), nullptr);
+
+    // the released slot is acquired again and starts empty
+    CycleCounter counter;
+    counter.prepare("zldsp::test::counter", &counter);
+    ASSERT_NE(counter.getHistogram(), nullptr);
+    EXPECT_EQ(counter.getHistogram()->getStats(0).count, 0);
+}
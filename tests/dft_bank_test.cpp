@@ -0,0 +1,88 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include "fft/sliding_dft.hpp"
+#include "fft/goertzel_bank.hpp"
+
+namespace {
+    constexpr size_t kNumChannels = 3;
+    constexpr size_t kNumSamples = 1000;
+
+    std::array<std::vector<float>, kNumChannels> makeSines() {
+        std::array<std::vector<float>, kNumChannels> buffers;
+        for (size_t chan = 0; chan < kNumChannels; ++chan) {
+            buffers[chan].resize(kNumSamples);
+            // the bin-centered sine of the sliding DFT at 48 kHz and order 8 is 187.5 Hz * bin
+            const auto omega = 2.0 * std::numbers::pi * static_cast<double>(4 + 3 * chan) / 256.0;
+            for (size_t i = 0; i < kNumSamples; ++i) {
+                buffers[chan][i] = static_cast<float>(std::cos(omega * static_cast<double>(i)));
+            }
+        }
+        return buffers;
+    }
+}
+
+TEST(SlidingDFTTest, MultichannelMatchesSeparateChannels) {
+    const std::vector<size_t> bins{1, 4, 7, 10, 13};
+    auto buffers = makeSines();
+    std::array<float *, kNumChannels> pointers{};
+    for (size_t chan = 0; chan < kNumChannels; ++chan) {
+        pointers[chan] = buffers[chan].data();
+    }
+    zldsp::fft::SlidingDFT<float> multi;
+    multi.setOrder(8);
+    multi.setNumChannels(kNumChannels);
+    multi.setBins(bins);
+    multi.process(std::span(pointers), kNumSamples);
+    for (size_t chan = 0; chan < kNumChannels; ++chan) {
+        zldsp::fft::SlidingDFT<float> single;
+        single.setOrder(8);
+        single.setBins(bins);
+        single.process(buffers[chan].data(), kNumSamples);
+        for (size_t k = 0; k < bins.size(); ++k) {
+            EXPECT_FLOAT_EQ(multi.getBin(chan, k).real(), single.getBin(k).real());
+            EXPECT_FLOAT_EQ(multi.getBin(chan, k).imag(), single.getBin(k).imag());
+        }
+        EXPECT_NEAR(multi.getAmplitude(chan, chan + 1), 1.f, 1e-3f);
+    }
+}
+
+TEST(GoertzelBankTest, MultichannelMatchesSeparateChannels) {
+    const std::vector<double> freqs{750.0, 1312.5, 1875.0, 2000.0};
+    auto buffers = makeSines();
+    std::array<float *, kNumChannels> pointers{};
+    for (size_t chan = 0; chan < kNumChannels; ++chan) {
+        pointers[chan] = buffers[chan].data();
+    }
+    zldsp::fft::GoertzelBank<float> multi;
+    multi.setFrequencies(freqs);
+    multi.prepare(48000.0, kNumSamples, kNumChannels);
+    multi.process(std::span(pointers), kNumSamples);
+    for (size_t chan = 0; chan < kNumChannels; ++chan) {
+        zldsp::fft::GoertzelBank<float> single;
+        single.setFrequencies(freqs);
+        single.prepare(48000.0, kNumSamples);
+        single.process(buffers[chan].data(), kNumSamples);
+        for (size_t k = 0; k < freqs.size(); ++k) {
+            EXPECT_DOUBLE_EQ(multi.getBin(chan, k).real(), single.getBin(k).real());
+            EXPECT_DOUBLE_EQ(multi.getBin(chan, k).imag(), single.getBin(k).imag());
+        }
+        EXPECT_NEAR(multi.getAmplitude(chan, chan), 1.0, 1e-2);
+        EXPECT_NEAR(multi.getPhase(chan, chan), 0.0, 1e-2);
+    }
+}
@@ -0,0 +1,89 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "compressor/compressor.hpp"
+
+namespace {
+    constexpr double kSampleRate = 48000.0;
+    constexpr size_t kBlockSize = 480;
+
+    /**
+     * run a signal through a one-band DynamicIIR until it settles
+     * @return the realized gain of the last block in dB and the band gain the processor reports
+     */
+    template<typename SignalFunc>
+    std::pair<float, float> measureGain(const zldsp::filter::FilterType filter_type, const double freq,
+                                        const float static_gain, const float threshold, SignalFunc &&signal) {
+        zldsp::compressor::DynamicIIR<float, 2> dynamic;
+        dynamic.setFilterType(0, filter_type);
+        dynamic.setFreq(0, freq);
+        dynamic.setQ(0, 0.707);
+        dynamic.setGain(0, static_gain);
+        dynamic.setBandOn(0, true);
+        dynamic.getComputer(0).setThreshold(threshold);
+        dynamic.getComputer(0).setRatio(4.f);
+        // the second band is off and must stay transparent
+        dynamic.setFreq(1, 200.0);
+        dynamic.prepare(kSampleRate, 1);
+
+        std::vector<float> input(kBlockSize), output(kBlockSize);
+        std::vector<float *> pointers{output.data()};
+        size_t pos = 0;
+        for (size_t block = 0; block < 200; ++block) {
+            for (size_t i = 0; i < kBlockSize; ++i) {
+                input[i] = signal(pos++);
+            }
+            output = input;
+            pointers[0] = output.data();
+            dynamic.prepareBuffer();
+            dynamic.process(pointers, kBlockSize);
+        }
+        double input_square{0}, output_square{0};
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            input_square += static_cast<double>(input[i]) * static_cast<double>(input[i]);
+            output_square += static_cast<double>(output[i]) * static_cast<double>(output[i]);
+        }
+        return {static_cast<float>(10.0 * std::log10(output_square / input_square)), dynamic.getBandGainDB(0)};
+    }
+}
+
+TEST(DynamicIIRTest, PeakGainAtCentre) {
+    // one period per control block, so that the detector power does not ripple
+    const auto sine = [](const size_t n) {
+        return .5f * static_cast<float>(std::sin(2.0 * std::numbers::pi * 1500.0 * static_cast<double>(n) / kSampleRate));
+    };
+    // static gain only
+    const auto [static_gain, static_band_gain] = measureGain(zldsp::filter::FilterType::kPeak, 1500.0, 6.f, 0.f, sine);
+    EXPECT_NEAR(static_band_gain, 6.f, 1e-3f);
+    EXPECT_NEAR(static_gain, static_band_gain, .05f);
+    // static gain plus dynamic reduction
+    const auto [gain, band_gain] = measureGain(zldsp::filter::FilterType::kPeak, 1500.0, 3.f, -30.f, sine);
+    EXPECT_LT(band_gain, -5.f);
+    EXPECT_NEAR(gain, band_gain, .05f);
+}
+
+TEST(DynamicIIRTest, ShelfGainAtDCAndNyquist) {
+    const auto dc = [](size_t) { return .5f; };
+    const auto [low_gain, low_band_gain] = measureGain(zldsp::filter::FilterType::kLowShelf, 500.0, 0.f, -30.f, dc);
+    EXPECT_LT(low_band_gain, -5.f);
+    EXPECT_NEAR(low_gain, low_band_gain, .05f);
+
+    const auto nyquist = [](const size_t n) { return n % 2 == 0 ? .5f : -.5f; };
+    const auto [high_gain, high_band_gain] = measureGain(zldsp::filter::FilterType::kHighShelf, 5000.0, -3.f, -30.f,
+                                                         nyquist);
+    EXPECT_LT(high_band_gain, -8.f);
+    EXPECT_NEAR(high_gain, high_band_gain, .05f);
+}
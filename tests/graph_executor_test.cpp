@@ -0,0 +1,220 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graph/graph.hpp"
+
+using zldsp::graph::GraphExecutor;
+using zldsp::graph::NodeBase;
+using zldsp::graph::WorkStealingDeque;
+
+namespace {
+    /**
+     * a node which multiplies its input and adds an offset, and records when it starts and ends
+     */
+    class AffineNode final : public NodeBase<float> {
+    public:
+        AffineNode(std::atomic<int> &clock, const float gain, const float offset)
+            : clock_(clock), gain_(gain), offset_(offset) {
+        }
+
+        void process(std::span<float *> buffer, const size_t num_samples) override {
+            start = clock_.fetch_add(1, std::memory_order::relaxed);
+            for (auto *channel: buffer) {
+                for (size_t i = 0; i < num_samples; ++i) {
+                    channel[i] = channel[i] * gain_ + offset_;
+                }
+            }
+            end = clock_.fetch_add(1, std::memory_order::relaxed);
+        }
+
+        int start{-1}, end{-1};
+
+    private:
+        std::atomic<int> &clock_;
+        float gain_, offset_;
+    };
+
+    void fillSource(GraphExecutor<float> &executor, const size_t idx, const float x) {
+        for (auto *channel: executor.getNodeBuffer(idx)) {
+            std::fill(channel, channel + 64, x);
+        }
+    }
+}
+
+TEST(WorkStealingDequeTest, OwnerPopsLastAndThievesStealFirst) {
+    WorkStealingDeque deque{5};
+    EXPECT_EQ(deque.pop(), WorkStealingDeque::kEmpty);
+    EXPECT_EQ(deque.steal(), WorkStealingDeque::kEmpty);
+    // the indices grow across many rounds, so the elements wrap around the buffer of 8
+    for (int round = 0; round < 100; ++round) {
+        for (int x = 0; x < 5; ++x) {
+            deque.push(round * 5 + x);
+        }
+        EXPECT_EQ(deque.steal(), round * 5);
+        EXPECT_EQ(deque.pop(), round * 5 + 4);
+        EXPECT_EQ(deque.steal(), round * 5 + 1);
+        EXPECT_EQ(deque.pop(), round * 5 + 3);
+        EXPECT_EQ(deque.pop(), round * 5 + 2);
+        EXPECT_EQ(deque.pop(), WorkStealingDeque::kEmpty);
+        EXPECT_EQ(deque.steal(), WorkStealingDeque::kEmpty);
+    }
+}
+
+TEST(WorkStealingDequeTest, EveryElementIsTakenOnceUnderStealRaces) {
+    constexpr int kNumElements = 256;
+    constexpr size_t kNumThieves = 3;
+    WorkStealingDeque deque{kNumElements};
+    for (int round = 0; round < 50; ++round) {
+        std::array<std::atomic<int>, kNumElements> taken{};
+        std::atomic<bool> start{false};
+        std::atomic<int> num_taken{0};
+        for (int x = 0; x < kNumElements; ++x) {
+            deque.push(x);
+        }
+        std::vector<std::thread> thieves;
+        for (size_t k = 0; k < kNumThieves; ++k) {
+            thieves.emplace_back([&]() {
+                while (!start.load(std::memory_order::acquire)) {
+                    std::this_thread::yield();
+                }
+                while (num_taken.load(std::memory_order::acquire) < kNumElements) {
+                    const auto x = deque.steal();
+                    if (x != WorkStealingDeque::kEmpty) {
+                        taken[static_cast<size_t>(x)].fetch_add(1);
+                        num_taken.fetch_add(1, std::memory_order::acq_rel);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        start.store(true, std::memory_order::release);
+        // the owner races the thieves for the same elements, down to the last one
+        while (num_taken.load(std::memory_order::acquire) < kNumElements) {
+            const auto x = deque.pop();
+            if (x != WorkStealingDeque::kEmpty) {
+                taken[static_cast<size_t>(x)].fetch_add(1);
+                num_taken.fetch_add(1, std::memory_order::acq_rel);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        for (auto &thief: thieves) {
+            thief.join();
+        }
+        for (int x = 0; x < kNumElements; ++x) {
+            ASSERT_EQ(taken[static_cast<size_t>(x)].load(), 1) << "round " << round << " element " << x;
+        }
+        EXPECT_EQ(deque.pop(), WorkStealingDeque::kEmpty);
+    }
+}
+
+TEST(GraphExecutorTest, RejectsCycles) {
+    std::atomic<int> clock{0};
+    AffineNode a{clock, 1.f, 0.f}, b{clock, 1.f, 0.f};
+    GraphExecutor<float> executor;
+    const auto ia = executor.addNode(a, 1);
+    const auto ib = executor.addNode(b, 1);
+    executor.addEdge(ia, ib);
+    executor.addEdge(ib, ia);
+    EXPECT_FALSE(executor.prepare(64, 2));
+}
+
+TEST(GraphExecutorTest, RunsNodesAfterTheirPredecessors) {
+    for (const size_t num_workers: {0, 1, 3}) {
+        // source -> {left, right} -> sink, plus a long chain from the source into the sink
+        std::atomic<int> clock{0};
+        AffineNode source{clock, 1.f, 0.f}, left{clock, 2.f, 1.f}, right{clock, 3.f, 0.f}, sink{clock, 1.f, .5f};
+        std::vector<AffineNode> chain;
+        chain.reserve(8);
+        for (size_t k = 0; k < 8; ++k) {
+            chain.emplace_back(clock, 1.f, 1.f);
+        }
+        GraphExecutor<float> executor;
+        const auto is = executor.addNode(source, 2);
+        const auto il = executor.addNode(left, 2);
+        const auto ir = executor.addNode(right, 1);
+        const auto ik = executor.addNode(sink, 2);
+        std::vector<std::pair<size_t, size_t> > edges{{is, il}, {is, ir}, {il, ik}, {ir, ik}};
+        auto previous = is;
+        for (auto &node: chain) {
+            const auto idx = executor.addNode(node, 2);
+            edges.emplace_back(previous, idx);
+            previous = idx;
+        }
+        edges.emplace_back(previous, ik);
+        for (const auto &[from, to]: edges) {
+            executor.addEdge(from, to);
+        }
+        ASSERT_TRUE(executor.prepare(64, num_workers));
+        EXPECT_EQ(executor.getNumWorkers(), num_workers);
+        for (int run = 0; run < 200; ++run) {
+            const auto x = static_cast<float>(run % 7);
+            fillSource(executor, is, x);
+            executor.process(64);
+            for (const auto &[from, to]: edges) {
+                const auto &pre = from == is ? source : from == il ? left : from == ir ? right : chain[from - 4];
+                const auto &post = to == ik ? sink : to == il ? left : to == ir ? right : chain[to - 4];
+                ASSERT_LT(pre.end, post.start) << "workers " << num_workers << " run " << run;
+            }
+            // the right branch has one channel, so the second channel of the sink misses it
+            const auto sink_buffer = executor.getNodeBuffer(ik);
+            const auto expected0 = (2.f * x + 1.f) + 3.f * x + (x + 8.f) + .5f;
+            const auto expected1 = (2.f * x + 1.f) + (x + 8.f) + .5f;
+            for (size_t i = 0; i < 64; ++i) {
+                ASSERT_FLOAT_EQ(sink_buffer[0][i], expected0);
+                ASSERT_FLOAT_EQ(sink_buffer[1][i], expected1);
+            }
+        }
+    }
+}
+
+TEST(GraphExecutorTest, RepeatedRunsOfAWideGraphMatchTheSerialRun) {
+    constexpr size_t kNumBranches = 16;
+    std::atomic<int> clock{0};
+    std::vector<AffineNode> nodes;
+    nodes.reserve(kNumBranches * 2 + 2);
+    for (size_t k = 0; k < kNumBranches * 2 + 2; ++k) {
+        nodes.emplace_back(clock, 1.f + static_cast<float>(k % 3), static_cast<float>(k) * .25f);
+    }
+    std::array<GraphExecutor<float>, 2> executors;
+    std::array<std::vector<float>, 2> outputs;
+    for (size_t e = 0; e < 2; ++e) {
+        auto &executor{executors[e]};
+        for (auto &node: nodes) {
+            executor.addNode(node, 1);
+        }
+        // node 0 fans out into branches of two nodes, which all meet in the last node
+        for (size_t k = 0; k < kNumBranches; ++k) {
+            executor.addEdge(0, 1 + 2 * k);
+            executor.addEdge(1 + 2 * k, 2 + 2 * k);
+            executor.addEdge(2 + 2 * k, nodes.size() - 1);
+        }
+        ASSERT_TRUE(executor.prepare(64, e == 0 ? 0 : 3));
+    }
+    for (int run = 0; run < 1000; ++run) {
+        for (size_t e = 0; e < 2; ++e) {
+            fillSource(executors[e], 0, static_cast<float>(run % 11) - 5.f);
+            executors[e].process(static_cast<size_t>(run % 64) + 1);
+            const auto *sink = executors[e].getNodeBuffer(nodes.size() - 1)[0];
+            outputs[e].assign(sink, sink + static_cast<size_t>(run % 64) + 1);
+        }
+        ASSERT_EQ(outputs[0], outputs[1]) << "run " << run;
+    }
+}
@@ -0,0 +1,42 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "compressor/computer/computer.hpp"
+
+template<bool OutputDiff>
+void expectBlockMatchesScalar(const float curve) {
+    zldsp::compressor::KneeComputer<float, OutputDiff> computer;
+    computer.setThreshold(-24.f);
+    computer.setRatio(4.f);
+    computer.setKneeW(6.f);
+    computer.setCurve(curve);
+    computer.prepareBuffer();
+    std::vector<float> xs, ys;
+    for (float x = -80.f; x <= 12.f; x += .25f) {
+        xs.push_back(x);
+    }
+    ys.resize(xs.size());
+    computer.eval(xs, ys);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        EXPECT_NEAR(ys[i], computer.eval(xs[i]), 1e-4f) << xs[i];
+    }
+}
+
+TEST(KneeComputerTest, BlockEvalMatchesScalarEval) {
+    for (const auto curve: {-1.f, -.5f, 0.f, .5f, 1.f}) {
+        expectBlockMatchesScalar<false>(curve);
+        expectBlockMatchesScalar<true>(curve);
+    }
+}
@@ -0,0 +1,68 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mag_analyzer/multiple_mag_analyzer.hpp"
+
+using zldsp::analyzer::MagType;
+using zldsp::analyzer::MultipleMagAnalyzer;
+
+TEST(MagStatsTest, StatsMatchPeakAndRMS) {
+    constexpr size_t kPointNum = 64;
+    // neither the block size nor the point length is a multiple of the stats lanes
+    constexpr size_t kBlockSize = 101;
+    std::array<MultipleMagAnalyzer<float, 1, kPointNum>, 3> analyzers;
+    const std::array types{MagType::kStats, MagType::kPeak, MagType::kRMS};
+    for (size_t k = 0; k < analyzers.size(); ++k) {
+        analyzers[k].setMagType(types[k]);
+        analyzers[k].setTimeLength(.1f);
+        analyzers[k].prepare(48000.0);
+    }
+
+    std::array<std::vector<float>, 2> data;
+    for (auto &channel: data) {
+        channel.resize(kBlockSize);
+    }
+    std::array<float *, 2> pointers{data[0].data(), data[1].data()};
+    for (size_t block = 0; block < 60; ++block) {
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            const auto t = static_cast<double>(block * kBlockSize + i);
+            const auto level = static_cast<double>(block % 5 + 1) * .15;
+            data[0][i] = static_cast<float>(std::sin(t * .013) * level);
+            data[1][i] = static_cast<float>(std::sin(t * .071) * level * .5 - .1);
+        }
+        for (auto &analyzer: analyzers) {
+            analyzer.process({std::span<float *>(pointers)}, kBlockSize);
+        }
+    }
+    const auto num_ready = analyzers[0].run();
+    ASSERT_GT(num_ready, 4);
+    for (size_t k = 1; k < analyzers.size(); ++k) {
+        EXPECT_EQ(analyzers[k].run(), num_ready);
+    }
+
+    // with a height of max_db - min_db, a path point is the negative dB value
+    std::array<float, kPointNum> xs{}, peaks{}, rmss{};
+    analyzers[1].createPath(xs, {std::span<float>(peaks)}, 1.f, 72.f);
+    analyzers[2].createPath(xs, {std::span<float>(rmss)}, 1.f, 72.f);
+    const auto &stats = analyzers[0].getStats()[0];
+    for (size_t idx = kPointNum - static_cast<size_t>(num_ready); idx < kPointNum; ++idx) {
+        EXPECT_NEAR(stats[idx].peak_db, -peaks[idx], 1e-3f);
+        EXPECT_NEAR(stats[idx].rms_db, -rmss[idx], 1e-3f);
+        EXPECT_LE(stats[idx].min, stats[idx].max);
+        EXPECT_NEAR(std::max(std::abs(stats[idx].min), std::abs(stats[idx].max)),
+                    std::pow(10.f, stats[idx].peak_db / 20.f), 1e-4f);
+    }
+}
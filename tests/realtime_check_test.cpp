@@ -0,0 +1,219 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+// the processors are driven through the real-time checker, this file is built with ZLDSP_ENABLE_REALTIME_CHECK
+// and chore/realtime_check.cpp, see CMakeLists.txt
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "chore/chore.hpp"
+#include "gain/gain.hpp"
+#include "filter/filter.hpp"
+#include "delay/delay.hpp"
+#include "over_sample/over_sample.hpp"
+#include "compressor/compressor.hpp"
+#include "fft_analyzer/fft_analyzer.hpp"
+#include "mag_analyzer/mag_analyzer.hpp"
+
+namespace {
+    std::atomic<int> num_violations{0};
+    std::atomic<const char *> last_scope{nullptr};
+
+    void countViolation(const char *, const char *scope) {
+        last_scope.store(scope, std::memory_order::relaxed);
+        num_violations.fetch_add(1, std::memory_order::relaxed);
+    }
+
+    class RealTimeCheckTest : public ::testing::Test {
+    protected:
+        static constexpr size_t kNumSamples = 512;
+        // a few blocks, so that the paths after the first block (e.g. the FIFO overflows) are taken as well
+        static constexpr size_t kNumBlocks = 16;
+
+        std::vector<std::vector<float> > data_;
+        std::vector<float *> pointers_;
+
+        void SetUp() override {
+            data_.assign(2, std::vector<float>(kNumSamples));
+            pointers_.clear();
+            for (auto &channel: data_) {
+                pointers_.emplace_back(channel.data());
+            }
+            fillNoise();
+            num_violations.store(0, std::memory_order::relaxed);
+            last_scope.store(nullptr, std::memory_order::relaxed);
+            zldsp::chore::setRealTimeViolationHandler(countViolation);
+        }
+
+        void TearDown() override {
+            zldsp::chore::setRealTimeViolationHandler(nullptr);
+        }
+
+        std::span<float *> getSpan() { return {pointers_.data(), pointers_.size()}; }
+
+        void fillNoise() {
+            std::srand(42);
+            for (auto &channel: data_) {
+                for (auto &x: channel) {
+                    x = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 2.f - 1.f;
+                }
+            }
+        }
+    };
+}
+
+TEST_F(RealTimeCheckTest, ReportsAllocationsAndLocksInsideScope) {
+    // called through a volatile pointer, so that the allocation is not elided
+    void *(*volatile allocate)(size_t) = std::malloc;
+    std::mutex mutex;
+    void *ptr = nullptr; {
+        ZLDSP_REALTIME_SCOPE("zldsp::test::outer"); {
+            ZLDSP_REALTIME_SCOPE("zldsp::test::inner");
+            ptr = allocate(16);
+        }
+        EXPECT_STREQ(last_scope.load(), "zldsp::test::inner");
+        const std::lock_guard<std::mutex> lock(mutex);
+    }
+    std::free(ptr);
+    EXPECT_EQ(num_violations.load(), 2);
+    EXPECT_STREQ(last_scope.load(), "zldsp::test::outer");
+    // outside a scope nothing is reported
+    ptr = allocate(16);
+    std::free(ptr);
+    EXPECT_EQ(num_violations.load(), 2);
+}
+
+TEST_F(RealTimeCheckTest, NonRealTimeScopeSuspendsChecks) {
+    void *(*volatile allocate)(size_t) = std::malloc;
+    void *ptr = nullptr; {
+        ZLDSP_REALTIME_SCOPE("zldsp::test::outer"); {
+            ZLDSP_NON_REALTIME_SCOPE();
+            ptr = allocate(16);
+        }
+    }
+    std::free(ptr);
+    EXPECT_EQ(num_violations.load(), 0);
+}
+
+TEST_F(RealTimeCheckTest, GainFilterDelay) {
+    zldsp::gain::SafeGain<float> gain;
+    gain.prepare(48000.0, kNumSamples, 0.01);
+    zldsp::filter::IIR<float, 16> filter;
+    filter.prepare(48000.0, 2);
+    filter.setFilterType(zldsp::filter::FilterType::kLowPass);
+    filter.setOrder(8);
+    zldsp::delay::IntegerDelay<float> delay;
+    delay.prepare(48000.0, kNumSamples, 2, 0.1f);
+    delay.setDelayInSamples(100);
+    for (size_t i = 0; i < kNumBlocks; ++i) {
+        // the parameters change while processing
+        gain.setGainDecibels(-static_cast<float>(i));
+        filter.setFreq(1000.f + 100.f * static_cast<float>(i));
+        gain.process(getSpan(), kNumSamples);
+        filter.prepareBuffer();
+        filter.process(getSpan(), kNumSamples);
+        delay.process(getSpan(), kNumSamples);
+    }
+    EXPECT_EQ(num_violations.load(), 0);
+}
+
+TEST_F(RealTimeCheckTest, OverSampler) {
+    zldsp::oversample::OverSampler<float, 2> over_sampler;
+    over_sampler.prepare(2, kNumSamples);
+    for (size_t i = 0; i < kNumBlocks; ++i) {
+        over_sampler.upsample(getSpan(), kNumSamples);
+        over_sampler.downsample(getSpan(), kNumSamples);
+        over_sampler.process(getSpan(), kNumSamples, [](std::span<float *> os_buffer, const size_t num) {
+            for (auto *channel: os_buffer) {
+                for (size_t j = 0; j < num; ++j) {
+                    channel[j] = std::tanh(channel[j]);
+                }
+            }
+        });
+    }
+    EXPECT_EQ(num_violations.load(), 0);
+}
+
+TEST_F(RealTimeCheckTest, CompressorStyles) {
+    zldsp::compressor::KneeComputer<float> computer;
+    zldsp::compressor::RMSTracker<float> tracker;
+    zldsp::compressor::PSFollower<float> follower;
+    computer.setThreshold(-18.f);
+    computer.setRatio(4.f);
+    tracker.setMaximumMomentarySeconds(.1f);
+    tracker.prepare(48000.0);
+    tracker.setMomentarySeconds(.05f);
+    follower.prepare(48000.0);
+    zldsp::compressor::CleanCompressor<float> clean{computer, tracker, follower};
+    zldsp::compressor::ClassicCompressor<float> classic{computer, tracker, follower};
+    zldsp::compressor::OpticalCompressor<float> optical{computer, tracker, follower};
+    for (size_t i = 0; i < kNumBlocks; ++i) {
+        computer.prepareBuffer();
+        tracker.prepareBuffer();
+        follower.prepareBuffer();
+        fillNoise();
+        clean.process<false>(pointers_[0], kNumSamples);
+        clean.process<true>(pointers_[1], kNumSamples);
+        fillNoise();
+        classic.process<false, true>(pointers_[0], kNumSamples);
+        classic.process<true>(pointers_[1], kNumSamples);
+        fillNoise();
+        optical.process<false>(pointers_[0], kNumSamples);
+        optical.process<true>(pointers_[1], kNumSamples);
+    }
+    EXPECT_EQ(num_violations.load(), 0);
+}
+
+TEST_F(RealTimeCheckTest, RMSTrackerModes) {
+    zldsp::compressor::RMSTracker<float> tracker;
+    tracker.setMaximumMomentarySeconds(.1f);
+    tracker.prepare(48000.0);
+    constexpr std::array modes{
+        zldsp::compressor::kBoxcar, zldsp::compressor::kExponential,
+        zldsp::compressor::kCascade, zldsp::compressor::kBoxcar
+    };
+    for (size_t i = 0; i < kNumBlocks; ++i) {
+        // switch the mode and shrink / grow the window while processing
+        tracker.setMode(modes[i % modes.size()]);
+        tracker.setMomentarySeconds(i % 2 == 0 ? .01f : .1f);
+        tracker.prepareBuffer();
+        for (const auto x: data_[0]) {
+            tracker.processSample(x);
+        }
+    }
+    EXPECT_EQ(num_violations.load(), 0);
+}
+
+TEST_F(RealTimeCheckTest, Analyzers) {
+    zldsp::analyzer::MultipleFFTBase<float, 2, 251> fft_analyzer(11);
+    fft_analyzer.prepare(48000.0);
+    fft_analyzer.setON({true, true});
+    zldsp::analyzer::MultipleMagAnalyzer<float, 2, 251> mag_analyzer;
+    mag_analyzer.prepare(48000.0);
+    zldsp::analyzer::OctaveAnalyzer<float, 3, 8, 64> octave_analyzer;
+    octave_analyzer.prepare(48000.0, 2, kNumSamples);
+    zldsp::analyzer::CorrelationAnalyzer<float, 251> correlation_analyzer;
+    correlation_analyzer.prepare(48000.0);
+    // run is not called, so the FIFOs fill up and process takes the overflow paths
+    for (size_t i = 0; i < kNumBlocks * 8; ++i) {
+        fft_analyzer.process({getSpan(), getSpan()}, kNumSamples);
+        mag_analyzer.process({getSpan(), getSpan()}, kNumSamples);
+        octave_analyzer.process(getSpan(), kNumSamples);
+        correlation_analyzer.process(getSpan(), kNumSamples);
+    }
+    EXPECT_EQ(num_violations.load(), 0);
+}
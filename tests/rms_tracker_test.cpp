@@ -0,0 +1,52 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+
+#include <gtest/gtest.h>
+
+#include "compressor/tracker/rms_tracker.hpp"
+
+using zldsp::compressor::RMSTracker;
+
+TEST(RMSTrackerTest, BoxcarIsClampedToTheAllocatedBuffer) {
+    // no boxcar memory is allocated, so the boxcar falls back to a single sample
+    RMSTracker<float> tracker;
+    tracker.setMaximumMomentarySeconds(0.f);
+    tracker.setMomentarySeconds(.1f);
+    tracker.setMode(zldsp::compressor::kExponential);
+    tracker.prepare(48000.0);
+    tracker.prepareBuffer();
+    EXPECT_EQ(tracker.getCurrentBufferSize(), 4800u);
+    tracker.setMode(zldsp::compressor::kBoxcar);
+    tracker.prepareBuffer();
+    EXPECT_EQ(tracker.getCurrentBufferSize(), 1u);
+    for (size_t i = 0; i < 48000; ++i) {
+        tracker.processSample(.5f);
+    }
+    EXPECT_NEAR(tracker.getMomentarySquare(), .25f, 1e-6f);
+    EXPECT_NEAR(tracker.getMomentaryDB(), -6.0206f, 1e-3f);
+}
+
+TEST(RMSTrackerTest, BoxcarKeepsTheRequestedWindowWithinCapacity) {
+    RMSTracker<float> tracker;
+    tracker.setMaximumMomentarySeconds(.2f);
+    tracker.setMomentarySeconds(.1f);
+    tracker.prepare(48000.0);
+    tracker.prepareBuffer();
+    EXPECT_EQ(tracker.getCurrentBufferSize(), 4800u);
+    tracker.setMomentarySeconds(.5f);
+    tracker.prepareBuffer();
+    EXPECT_EQ(tracker.getCurrentBufferSize(), 9600u);
+    for (size_t i = 0; i < 48000; ++i) {
+        tracker.processSample(.5f);
+    }
+    EXPECT_NEAR(tracker.getMomentarySquare(), .25f * 9600.f, 1e-1f);
+    EXPECT_NEAR(tracker.getMomentaryDB(), -6.0206f, 1e-3f);
+}
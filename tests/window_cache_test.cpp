@@ -0,0 +1,30 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include "fft/window.hpp"
+
+using zldsp::fft::WindowCache;
+using zldsp::fft::WindowType;
+
+TEST(WindowCacheTest, SharesWindowsAndErasesReleasedEntries) {
+    auto &cache = WindowCache<float>::getInstance();
+    const auto num_entries = cache.getNumEntries();
+    auto hann = cache.get(WindowType::kHann, 64, true);
+    EXPECT_EQ(cache.get(WindowType::kHann, 64, true), hann);
+    EXPECT_EQ(cache.getNumEntries(), num_entries + 1);
+    // the released window is erased when the next window is created
+    hann.reset();
+    for (size_t order = 7; order < 12; ++order) {
+        const auto window = cache.get(WindowType::kHann, static_cast<size_t>(1) << order, true);
+        EXPECT_EQ(cache.getNumEntries(), num_entries + 1);
+    }
+}
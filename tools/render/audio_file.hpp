@@ -0,0 +1,311 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace zldsp::tools {
+    /**
+     * a read-only memory mapping of a whole file
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &path) {
+            const auto fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("cannot open " + path);
+            }
+            struct stat st{};
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                throw std::runtime_error("cannot stat " + path);
+            }
+            size_ = static_cast<size_t>(st.st_size);
+            if (size_ > 0) {
+                auto *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("cannot map " + path);
+                }
+                data_ = static_cast<const std::uint8_t *>(data);
+                // the file is read once from the front to the back
+                ::madvise(data, size_, MADV_SEQUENTIAL);
+            }
+            ::close(fd);
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile() {
+            if (data_ != nullptr) {
+                ::munmap(const_cast<std::uint8_t *>(data_), size_);
+            }
+        }
+
+        [[nodiscard]] std::span<const std::uint8_t> getBytes() const { return {data_, size_}; }
+
+    private:
+        const std::uint8_t *data_{nullptr};
+        size_t size_{0};
+    };
+
+    enum SampleFormat {
+        kInt16, kInt24, kInt32, kFloat32
+    };
+
+    /**
+     * interleaved samples inside a mapped file, either a WAV file or raw 32-bit floats
+     */
+    class AudioSource {
+    public:
+        /**
+         * @param path a .wav file, any other file is read as raw interleaved 32-bit floats
+         * @param raw_num_channels the number of channels of a raw file
+         * @param raw_sample_rate the sample rate of a raw file
+         */
+        AudioSource(const std::string &path, const size_t raw_num_channels, const double raw_sample_rate)
+            : file_(path) {
+            const auto bytes = file_.getBytes();
+            if (isWav(path)) {
+                parseWav(bytes);
+            } else {
+                num_channels_ = raw_num_channels;
+                sample_rate_ = raw_sample_rate;
+                format_ = kFloat32;
+                samples_ = bytes;
+            }
+            if (num_channels_ == 0 || sample_rate_ <= 0.0) {
+                throw std::runtime_error("invalid channels / sample rate in " + path);
+            }
+            num_frames_ = samples_.size() / (num_channels_ * getBytesPerSample());
+        }
+
+        [[nodiscard]] size_t getNumChannels() const { return num_channels_; }
+
+        [[nodiscard]] double getSampleRate() const { return sample_rate_; }
+
+        [[nodiscard]] size_t getNumFrames() const { return num_frames_; }
+
+        /**
+         * convert frames to float and de-interleave them
+         * @param start the first frame
+         * @param num_frames
+         * @param buffer one pointer per channel
+         */
+        void read(const size_t start, const size_t num_frames, std::span<float *> buffer) const {
+            const auto bytes_per_sample = getBytesPerSample();
+            const auto *frame = samples_.data() + start * num_channels_ * bytes_per_sample;
+            for (size_t i = 0; i < num_frames; ++i) {
+                for (size_t chan = 0; chan < num_channels_; ++chan) {
+                    buffer[chan][i] = decode(frame);
+                    frame += bytes_per_sample;
+                }
+            }
+        }
+
+    private:
+        MappedFile file_;
+        std::span<const std::uint8_t> samples_;
+        size_t num_channels_{0}, num_frames_{0};
+        double sample_rate_{0.0};
+        SampleFormat format_{kFloat32};
+
+        static bool isWav(const std::string &path) {
+            if (path.size() < 4) return false;
+            auto extension = path.substr(path.size() - 4);
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension == ".wav";
+        }
+
+        template<typename T>
+        static T load(const std::uint8_t *p) {
+            // the mapped data is not necessarily aligned
+            T x;
+            std::memcpy(&x, p, sizeof(T));
+            return x;
+        }
+
+        [[nodiscard]] size_t getBytesPerSample() const {
+            switch (format_) {
+                case kInt16: return 2;
+                case kInt24: return 3;
+                case kInt32:
+                case kFloat32:
+                default: return 4;
+            }
+        }
+
+        [[nodiscard]] float decode(const std::uint8_t *p) const {
+            switch (format_) {
+                case kInt16: return static_cast<float>(load<std::int16_t>(p)) * (1.f / 32768.f);
+                case kInt24: {
+                    const auto x = static_cast<std::int32_t>(static_cast<std::uint32_t>(p[0]) << 8 |
+                                                             static_cast<std::uint32_t>(p[1]) << 16 |
+                                                             static_cast<std::uint32_t>(p[2]) << 24);
+                    return static_cast<float>(x >> 8) * (1.f / 8388608.f);
+                }
+                case kInt32: return static_cast<float>(static_cast<double>(load<std::int32_t>(p)) * (1.0 / 2147483648.0));
+                case kFloat32:
+                default: return load<float>(p);
+            }
+        }
+
+        void parseWav(const std::span<const std::uint8_t> bytes) {
+            if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0
+                || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+                throw std::runtime_error("not a RIFF / WAVE file");
+            }
+            bool has_format = false;
+            size_t pos = 12;
+            while (pos + 8 <= bytes.size()) {
+                const auto *chunk = bytes.data() + pos;
+                const auto chunk_size = static_cast<size_t>(load<std::uint32_t>(chunk + 4));
+                const auto body = pos + 8;
+                if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16 && body + 16 <= bytes.size()) {
+                    auto tag = load<std::uint16_t>(chunk + 8);
+                    num_channels_ = load<std::uint16_t>(chunk + 10);
+                    sample_rate_ = static_cast<double>(load<std::uint32_t>(chunk + 12));
+                    const auto bits = load<std::uint16_t>(chunk + 22);
+                    if (tag == 0xFFFE && chunk_size >= 40 && body + 40 <= bytes.size()) {
+                        // WAVE_FORMAT_EXTENSIBLE, the format tag is the start of the sub-format GUID
+                        tag = load<std::uint16_t>(chunk + 32);
+                    }
+                    if (tag == 3 && bits == 32) {
+                        format_ = kFloat32;
+                    } else if (tag == 1 && bits == 16) {
+                        format_ = kInt16;
+                    } else if (tag == 1 && bits == 24) {
+                        format_ = kInt24;
+                    } else if (tag == 1 && bits == 32) {
+                        format_ = kInt32;
+                    } else {
+                        throw std::runtime_error("unsupported WAV sample format");
+                    }
+                    has_format = true;
+                } else if (std::memcmp(chunk, "data", 4) == 0) {
+                    if (!has_format) {
+                        throw std::runtime_error("WAV data chunk before fmt chunk");
+                    }
+                    // a truncated file keeps the samples that are present
+                    samples_ = bytes.subspan(body, std::min(chunk_size, bytes.size() - body));
+                    return;
+                }
+                // chunks are padded to an even size
+                pos = body + chunk_size + (chunk_size & 1);
+            }
+            throw std::runtime_error("WAV file without data chunk");
+        }
+    };
+
+    /**
+     * writes a 32-bit float WAV file block by block
+     * files whose sizes do not fit into 32 bits are written as RF64 (EBU Tech 3306)
+     */
+    class WavWriter {
+    public:
+        WavWriter(const std::string &path, const size_t num_channels, const double sample_rate,
+                  const size_t num_frames)
+            : stream_(path, std::ios::binary), path_(path), num_channels_(num_channels) {
+            if (!stream_) {
+                throw std::runtime_error("cannot create " + path);
+            }
+            const auto data_size = static_cast<std::uint64_t>(num_frames) * num_channels * sizeof(float);
+            const auto block_align = static_cast<std::uint16_t>(num_channels * sizeof(float));
+            const auto rate = static_cast<std::uint32_t>(sample_rate);
+            // WAVE + fmt chunk + data chunk header
+            const auto riff_size = 4 + 24 + 8 + data_size;
+            if (riff_size <= kMaxUInt32) {
+                stream_.write("RIFF", 4);
+                writeValue(static_cast<std::uint32_t>(riff_size));
+                stream_.write("WAVE", 4);
+            } else {
+                // the 32-bit sizes are set to -1, the real ones are in the ds64 chunk
+                stream_.write("RF64", 4);
+                writeValue(static_cast<std::uint32_t>(kMaxUInt32));
+                stream_.write("WAVEds64", 8);
+                writeValue(static_cast<std::uint32_t>(28));
+                writeValue(static_cast<std::uint64_t>(riff_size + 36));
+                writeValue(data_size);
+                writeValue(static_cast<std::uint64_t>(num_frames));
+                writeValue(static_cast<std::uint32_t>(0));
+            }
+            stream_.write("fmt ", 4);
+            writeValue(static_cast<std::uint32_t>(16));
+            writeValue(static_cast<std::uint16_t>(3));
+            writeValue(static_cast<std::uint16_t>(num_channels));
+            writeValue(rate);
+            writeValue(static_cast<std::uint32_t>(rate * block_align));
+            writeValue(block_align);
+            writeValue(static_cast<std::uint16_t>(32));
+            stream_.write("data", 4);
+            writeValue(static_cast<std::uint32_t>(std::min(data_size, kMaxUInt32)));
+        }
+
+        /**
+         * interleave and append frames
+         * @param buffer one pointer per channel
+         * @param start the first frame of the buffer to write
+         * @param num_frames
+         */
+        void write(std::span<float *> buffer, const size_t start, const size_t num_frames) {
+            interleaved_.resize(num_frames * num_channels_);
+            for (size_t i = 0; i < num_frames; ++i) {
+                for (size_t chan = 0; chan < num_channels_; ++chan) {
+                    interleaved_[i * num_channels_ + chan] = buffer[chan][start + i];
+                }
+            }
+            stream_.write(reinterpret_cast<const char *>(interleaved_.data()),
+                          static_cast<std::streamsize>(interleaved_.size() * sizeof(float)));
+            if (!stream_) {
+                throw std::runtime_error("cannot write " + path_);
+            }
+        }
+
+        /**
+         * flush and close the file
+         */
+        void close() {
+            stream_.close();
+            if (!stream_) {
+                throw std::runtime_error("cannot write " + path_);
+            }
+        }
+
+    private:
+        static constexpr std::uint64_t kMaxUInt32 = 0xffffffffull;
+
+        std::ofstream stream_;
+        std::string path_;
+        size_t num_channels_;
+        std::vector<float> interleaved_;
+
+        template<typename T>
+        void writeValue(const T x) {
+            stream_.write(reinterpret_cast<const char *>(&x), sizeof(T));
+        }
+    };
+}
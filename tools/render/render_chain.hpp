@@ -0,0 +1,369 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "adaa/adaa.hpp"
+#include "chore/decibels.hpp"
+#include "compressor/compressor.hpp"
+#include "filter/filter.hpp"
+#include "gain/gain.hpp"
+#include "over_sample/over_sample.hpp"
+
+namespace zldsp::tools {
+    /**
+     * the parameters of one stage, e.g. "freq=1000 gain=3"
+     */
+    class StageConfig {
+    public:
+        StageConfig() = default;
+
+        StageConfig(std::string name, std::map<std::string, std::string> values)
+            : name_(std::move(name)), values_(std::move(values)) {
+        }
+
+        [[nodiscard]] const std::string &getName() const { return name_; }
+
+        [[nodiscard]] double get(const std::string &key, const double default_value) const {
+            const auto it = values_.find(key);
+            if (it == values_.end()) return default_value;
+            try {
+                return std::stod(it->second);
+            } catch (const std::exception &) {
+                throw std::runtime_error(name_ + ": invalid value of " + key + ": " + it->second);
+            }
+        }
+
+        [[nodiscard]] std::string get(const std::string &key, const std::string &default_value) const {
+            const auto it = values_.find(key);
+            return it == values_.end() ? default_value : it->second;
+        }
+
+    private:
+        std::string name_;
+        std::map<std::string, std::string> values_;
+    };
+
+    /**
+     * read a chain config, one stage per line, in processing order, e.g.
+     *     eq type=highpass freq=30 order=4
+     *     eq type=peak freq=3000 gain=-2 q=1.5
+     *     compressor threshold=-18 ratio=3 knee=6 attack=10 release=120 rms=0
+     *     saturation drive=6
+     *     gain db=-1
+     * everything after # is a comment
+     * @param path
+     * @return the stages
+     */
+    inline std::vector<StageConfig> readChainConfig(const std::string &path) {
+        std::ifstream stream(path);
+        if (!stream) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        std::vector<StageConfig> configs;
+        std::string line;
+        while (std::getline(stream, line)) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream tokens(line);
+            std::string name, token;
+            if (!(tokens >> name)) continue;
+            std::map<std::string, std::string> values;
+            while (tokens >> token) {
+                const auto pos = token.find('=');
+                if (pos == std::string::npos) {
+                    throw std::runtime_error(name + ": expected key=value, got " + token);
+                }
+                values[token.substr(0, pos)] = token.substr(pos + 1);
+            }
+            configs.emplace_back(name, std::move(values));
+        }
+        return configs;
+    }
+
+    class StageBase {
+    public:
+        virtual ~StageBase() = default;
+
+        /**
+         * @param sample_rate
+         * @param num_channels
+         * @param max_num_samples the maximum number of samples per process call
+         */
+        virtual void prepare(double sample_rate, size_t num_channels, size_t max_num_samples) = 0;
+
+        virtual void process(std::span<float *> buffer, size_t num_samples) = 0;
+
+        /**
+         * @return the latency in samples, valid after prepare
+         */
+        [[nodiscard]] virtual size_t getLatency() const { return 0; }
+    };
+
+    /**
+     * a cascade of biquads, e.g. type=peak freq=1000 gain=3 q=0.707 order=2
+     */
+    class EQStage final : public StageBase {
+    public:
+        explicit EQStage(const StageConfig &config) {
+            static const std::map<std::string, filter::FilterType> kTypes{
+                {"peak", filter::kPeak}, {"lowshelf", filter::kLowShelf}, {"lowpass", filter::kLowPass},
+                {"highshelf", filter::kHighShelf}, {"highpass", filter::kHighPass}, {"notch", filter::kNotch},
+                {"bandpass", filter::kBandPass}, {"tiltshelf", filter::kTiltShelf},
+                {"bandshelf", filter::kBandShelf}
+            };
+            const auto type = config.get("type", std::string("peak"));
+            const auto it = kTypes.find(type);
+            if (it == kTypes.end()) {
+                throw std::runtime_error("eq: unknown type " + type);
+            }
+            filter_.setFilterType(it->second);
+            filter_.setOrder(static_cast<size_t>(std::clamp(config.get("order", 2.0), 1.0, 32.0)));
+            filter_.setFreq(static_cast<float>(config.get("freq", 1000.0)));
+            filter_.setGain(static_cast<float>(config.get("gain", 0.0)));
+            filter_.setQ(static_cast<float>(config.get("q", 0.707)));
+        }
+
+        void prepare(const double sample_rate, const size_t num_channels, size_t) override {
+            filter_.prepare(sample_rate, num_channels);
+            filter_.prepareBuffer();
+            // start at the target parameters instead of ramping from the defaults
+            filter_.skipSmooth();
+        }
+
+        void process(std::span<float *> buffer, const size_t num_samples) override {
+            filter_.process(buffer, num_samples);
+        }
+
+    private:
+        filter::IIR<float, 16> filter_;
+    };
+
+    /**
+     * a clean compressor whose gain is linked across channels,
+     * e.g. threshold=-18 ratio=4 knee=6 attack=10 release=100 rms=0
+     * rms is the RMS window in milliseconds, 0 selects the peak detector
+     */
+    class CompressorStage final : public StageBase {
+    public:
+        explicit CompressorStage(const StageConfig &config)
+            : rms_ms_(static_cast<float>(config.get("rms", 0.0))) {
+            computer_.setThreshold(static_cast<float>(config.get("threshold", -18.0)));
+            computer_.setRatio(static_cast<float>(config.get("ratio", 2.0)));
+            computer_.setKneeW(static_cast<float>(config.get("knee", 6.0)));
+            follower_.setAttack(static_cast<float>(config.get("attack", 10.0)));
+            follower_.setRelease(static_cast<float>(config.get("release", 100.0)));
+        }
+
+        void prepare(const double sample_rate, size_t, const size_t max_num_samples) override {
+            tracker_.setMaximumMomentarySeconds(std::max(rms_ms_, 1.f) * .001f);
+            tracker_.prepare(sample_rate);
+            tracker_.setMomentarySeconds(std::max(rms_ms_, 1.f) * .001f);
+            follower_.prepare(sample_rate);
+            computer_.prepareBuffer();
+            tracker_.prepareBuffer();
+            follower_.prepareBuffer();
+            style_.reset();
+            side_.resize(max_num_samples);
+        }
+
+        void process(std::span<float *> buffer, const size_t num_samples) override {
+            // the sample with the largest magnitude of all channels drives the detector
+            for (size_t i = 0; i < num_samples; ++i) {
+                float x = 0.f;
+                for (const auto *channel: buffer) {
+                    if (std::abs(channel[i]) > std::abs(x)) x = channel[i];
+                }
+                side_[i] = x;
+            }
+            if (rms_ms_ > 0.f) {
+                style_.process<true>(side_.data(), num_samples);
+            } else {
+                style_.process<false>(side_.data(), num_samples);
+            }
+            // the style has turned the side-chain into the gain reduction in dB
+            for (size_t i = 0; i < num_samples; ++i) {
+                side_[i] = chore::decibelsToGain(side_[i]);
+            }
+            for (auto *channel: buffer) {
+                for (size_t i = 0; i < num_samples; ++i) {
+                    channel[i] *= side_[i];
+                }
+            }
+        }
+
+    private:
+        float rms_ms_;
+        compressor::KneeComputer<float, true> computer_;
+        compressor::RMSTracker<float> tracker_;
+        compressor::PSFollower<float> follower_;
+        compressor::CleanCompressor<float> style_{computer_, tracker_, follower_};
+        std::vector<float> side_;
+    };
+
+    /**
+     * a cubic soft clipper, anti-aliased with second-order ADAA
+     * the divided differences of ADAA cancel badly in float, so the clipper runs in double
+     */
+    class SoftClipper final : public adaa::ADAA2<double> {
+    protected:
+        double g0(const double x) override {
+            if (std::abs(x) <= 1.0) return x - x * x * x / 3.0;
+            return std::copysign(2.0 / 3.0, x);
+        }
+
+        double g1(const double x) override {
+            const auto a = std::abs(x);
+            if (a <= 1.0) return .5 * a * a - a * a * a * a / 12.0;
+            return 2.0 / 3.0 * a - .25;
+        }
+
+        double g2(const double x) override {
+            const auto a = std::abs(x);
+            if (a <= 1.0) return x * x * x / 6.0 - x * x * x * x * x / 60.0;
+            return std::copysign(a * a / 3.0 - .25 * a + 1.0 / 15.0, x);
+        }
+    };
+
+    /**
+     * the soft clipper at 4x over-sampling, e.g. drive=6 (dB before the clipper)
+     */
+    class SaturationStage final : public StageBase {
+    public:
+        // the over-sampled buffers only hold one sub-block, so that they stay in the cache
+        static constexpr size_t kSubBlockSize = 1024;
+
+        explicit SaturationStage(const StageConfig &config)
+            : drive_(chore::decibelsToGain(config.get("drive", 0.0))) {
+        }
+
+        void prepare(double, const size_t num_channels, size_t) override {
+            over_sampler_.prepare(num_channels, kSubBlockSize);
+            over_sampler_.reset();
+            clippers_.assign(num_channels, SoftClipper{});
+            sub_pointers_.resize(num_channels);
+        }
+
+        void process(std::span<float *> buffer, const size_t num_samples) override {
+            for (size_t start = 0; start < num_samples; start += kSubBlockSize) {
+                const auto num = std::min(num_samples - start, kSubBlockSize);
+                for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                    sub_pointers_[chan] = buffer[chan] + start;
+                }
+                const auto sub_buffer = std::span<float *>(sub_pointers_.data(), buffer.size());
+                over_sampler_.upsample(sub_buffer, num);
+                auto &os_pointers = over_sampler_.getOSPointer();
+                for (size_t chan = 0; chan < buffer.size(); ++chan) {
+                    auto &clipper = clippers_[chan];
+                    auto *samples = os_pointers[chan];
+                    for (size_t i = 0; i < (num << 2); ++i) {
+                        samples[i] = static_cast<float>(clipper.processADAA<true>(samples[i] * drive_));
+                    }
+                }
+                over_sampler_.downsample(sub_buffer, num);
+            }
+        }
+
+        [[nodiscard]] size_t getLatency() const override { return over_sampler_.getLatency(); }
+
+    private:
+        double drive_;
+        oversample::OverSampler<float, 2> over_sampler_;
+        std::vector<SoftClipper> clippers_;
+        std::vector<float *> sub_pointers_;
+    };
+
+    /**
+     * a static gain, e.g. db=-1
+     */
+    class GainStage final : public StageBase {
+    public:
+        explicit GainStage(const StageConfig &config)
+            : db_(static_cast<float>(config.get("db", 0.0))) {
+        }
+
+        void prepare(const double sample_rate, size_t, const size_t max_num_samples) override {
+            // a one-sample ramp, so the target is reached at the first sample
+            gain_.prepare(sample_rate, max_num_samples, 1.0 / sample_rate);
+            gain_.reset();
+            gain_.setGainDecibels(db_);
+        }
+
+        void process(std::span<float *> buffer, const size_t num_samples) override {
+            gain_.process(buffer, num_samples);
+        }
+
+    private:
+        float db_;
+        gain::Gain<float> gain_;
+    };
+
+    /**
+     * the stages of a config, each thread builds its own chain
+     */
+    class RenderChain {
+    public:
+        explicit RenderChain(const std::vector<StageConfig> &configs) {
+            for (const auto &config: configs) {
+                const auto &name = config.getName();
+                if (name == "eq") {
+                    stages_.emplace_back(std::make_unique<EQStage>(config));
+                } else if (name == "compressor") {
+                    stages_.emplace_back(std::make_unique<CompressorStage>(config));
+                } else if (name == "saturation") {
+                    stages_.emplace_back(std::make_unique<SaturationStage>(config));
+                } else if (name == "gain") {
+                    stages_.emplace_back(std::make_unique<GainStage>(config));
+                } else {
+                    throw std::runtime_error("unknown stage " + name);
+                }
+            }
+        }
+
+        /**
+         * call before each file, resets all states
+         */
+        void prepare(const double sample_rate, const size_t num_channels, const size_t max_num_samples) {
+            for (auto &stage: stages_) {
+                stage->prepare(sample_rate, num_channels, max_num_samples);
+            }
+        }
+
+        void process(std::span<float *> buffer, const size_t num_samples) {
+            for (auto &stage: stages_) {
+                stage->process(buffer, num_samples);
+            }
+        }
+
+        /**
+         * @return the total latency of all stages in samples, valid after prepare
+         */
+        [[nodiscard]] size_t getLatency() const {
+            size_t latency{0};
+            for (const auto &stage: stages_) {
+                latency += stage->getLatency();
+            }
+            return latency;
+        }
+
+    private:
+        std::vector<std::unique_ptr<StageBase> > stages_;
+    };
+}
@@ -0,0 +1,225 @@
+// Copyright (C) 2025 - zsliu98
+// This file is part of ZLCompressor
+//
+// ZLCompressor is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License Version 3 as published by the Free Software Foundation.
+//
+// ZLCompressor is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License along with ZLCompressor. If not, see <https://www.gnu.org/licenses/>.
+
+
+// an offline host which renders files through a chain of zldsp processors, e.g.
+//     zldsp_render --config chain.txt --output rendered --threads 8 a.wav b.wav
+// .wav files (16/24/32-bit integer or 32-bit float) and raw interleaved 32-bit floats (--channels, --rate)
+// are memory-mapped, the outputs are 32-bit float .wav files with the same names
+// an output which would overwrite an input, or another output, is refused before anything is rendered
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_file.hpp"
+#include "render_chain.hpp"
+
+namespace {
+    struct Options {
+        std::string config_path, output_dir{"."};
+        std::vector<std::string> inputs;
+        size_t num_threads{std::max(std::thread::hardware_concurrency(), 1u)};
+        size_t block_size{65536};
+        size_t raw_num_channels{2};
+        double raw_sample_rate{48000.0};
+    };
+
+    void printUsage() {
+        std::fprintf(stderr,
+                     "usage: zldsp_render --config <file> [--output <dir>] [--threads <n>] [--block <n>]\n"
+                     "                    [--channels <n>] [--rate <hz>] <input>...\n");
+    }
+
+    bool parseOptions(const int argc, char **argv, Options &options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                options.inputs.emplace_back(arg);
+                continue;
+            }
+            if (i + 1 >= argc) return false;
+            const std::string value = argv[++i];
+            try {
+                if (arg == "--config") {
+                    options.config_path = value;
+                } else if (arg == "--output") {
+                    options.output_dir = value;
+                } else if (arg == "--threads") {
+                    options.num_threads = std::max(std::stoul(value), 1ul);
+                } else if (arg == "--block") {
+                    options.block_size = std::max(std::stoul(value), 1ul);
+                } else if (arg == "--channels") {
+                    options.raw_num_channels = std::stoul(value);
+                } else if (arg == "--rate") {
+                    options.raw_sample_rate = std::stod(value);
+                } else {
+                    return false;
+                }
+            } catch (const std::exception &) {
+                return false;
+            }
+        }
+        return !options.config_path.empty() && !options.inputs.empty();
+    }
+
+    std::filesystem::path getOutputPath(const Options &options, const std::string &input) {
+        auto output_path = std::filesystem::path(options.output_dir) / std::filesystem::path(input).filename();
+        output_path.replace_extension(".wav");
+        return output_path;
+    }
+
+    /**
+     * the output is rendered into this file first and renamed when it is complete
+     */
+    std::filesystem::path getPartialPath(const std::filesystem::path &output_path) {
+        auto partial_path = output_path;
+        partial_path += ".partial";
+        return partial_path;
+    }
+
+    /**
+     * check that no output overwrites an input or another output
+     * @return the error message, empty if the outputs are safe
+     */
+    std::string checkOutputPaths(const Options &options) {
+        std::map<std::filesystem::path, size_t> outputs;
+        for (size_t idx = 0; idx < options.inputs.size(); ++idx) {
+            const auto &input = options.inputs[idx];
+            const auto output_path = getOutputPath(options, input);
+            const auto [it, inserted] = outputs.emplace(std::filesystem::absolute(output_path).lexically_normal(), idx);
+            if (!inserted) {
+                return input + " and " + options.inputs[it->second] + " are both rendered to " + output_path.string();
+            }
+            for (const auto &path: {output_path, getPartialPath(output_path)}) {
+                std::error_code ec;
+                if (!std::filesystem::exists(path, ec)) continue;
+                // equivalent also catches hard links and symbolic links to the inputs
+                for (const auto &other: options.inputs) {
+                    if (std::filesystem::equivalent(path, other, ec)) {
+                        return path.string() + " would overwrite the input " + other;
+                    }
+                }
+            }
+        }
+        return {};
+    }
+
+    /**
+     * render one file through the chain
+     * the latency of the chain is compensated, so the output is aligned with the input and has the same length
+     * @return the number of frames rendered
+     */
+    size_t renderFile(const Options &options, const std::string &input, zldsp::tools::RenderChain &chain,
+                      std::vector<std::vector<float> > &buffers, std::vector<float *> &pointers) {
+        const zldsp::tools::AudioSource source(input, options.raw_num_channels, options.raw_sample_rate);
+        const auto num_channels = source.getNumChannels();
+        const auto num_frames = source.getNumFrames();
+        buffers.resize(num_channels);
+        pointers.resize(num_channels);
+        for (size_t chan = 0; chan < num_channels; ++chan) {
+            buffers[chan].resize(options.block_size);
+            pointers[chan] = buffers[chan].data();
+        }
+        const auto buffer = std::span<float *>(pointers.data(), num_channels);
+        chain.prepare(source.getSampleRate(), num_channels, options.block_size);
+        const auto latency = chain.getLatency();
+
+        const auto output_path = getOutputPath(options, input);
+        const auto partial_path = getPartialPath(output_path);
+        try {
+            zldsp::tools::WavWriter writer(partial_path.string(), num_channels, source.getSampleRate(), num_frames);
+            // feed latency zeros after the input to flush the tail, and drop the first latency output frames
+            const auto num_total = num_frames + latency;
+            for (size_t start = 0; start < num_total; start += options.block_size) {
+                const auto num = std::min(num_total - start, options.block_size);
+                const auto num_read = start < num_frames ? std::min(num_frames - start, num) : 0;
+                source.read(start, num_read, buffer);
+                for (size_t chan = 0; chan < num_channels; ++chan) {
+                    std::fill(buffer[chan] + num_read, buffer[chan] + num, 0.f);
+                }
+                chain.process(buffer, num);
+                const auto num_skipped = start < latency ? std::min(latency - start, num) : 0;
+                writer.write(buffer, num_skipped, num - num_skipped);
+            }
+            writer.close();
+            std::filesystem::rename(partial_path, output_path);
+        } catch (...) {
+            std::error_code ec;
+            std::filesystem::remove(partial_path, ec);
+            throw;
+        }
+        return num_frames * num_channels;
+    }
+}
+
+int main(const int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    std::vector<zldsp::tools::StageConfig> configs;
+    try {
+        configs = zldsp::tools::readChainConfig(options.config_path);
+        // build one chain to validate the config before any thread starts
+        zldsp::tools::RenderChain check_chain(configs);
+        std::filesystem::create_directories(options.output_dir);
+        if (const auto message = checkOutputPaths(options); !message.empty()) {
+            throw std::runtime_error(message);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 2;
+    }
+
+    // the files are handed out one by one, so that long and short files balance across the threads
+    std::atomic<size_t> next_file{0};
+    std::atomic<size_t> num_samples{0}, num_failed{0};
+    std::mutex print_mutex;
+    const auto start_time = std::chrono::steady_clock::now();
+    auto worker = [&]() {
+        zldsp::tools::RenderChain chain(configs);
+        std::vector<std::vector<float> > buffers;
+        std::vector<float *> pointers;
+        for (auto idx = next_file.fetch_add(1); idx < options.inputs.size(); idx = next_file.fetch_add(1)) {
+            const auto &input = options.inputs[idx];
+            try {
+                num_samples.fetch_add(renderFile(options, input, chain, buffers, pointers));
+            } catch (const std::exception &e) {
+                num_failed.fetch_add(1);
+                const std::lock_guard<std::mutex> lock(print_mutex);
+                std::fprintf(stderr, "error: %s: %s\n", input.c_str(), e.what());
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    const auto num_threads = std::min(options.num_threads, options.inputs.size());
+    for (size_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    const auto total = static_cast<double>(num_samples.load());
+    std::printf("rendered %zu / %zu files, %.0f samples in %.3f s, %.3e samples/s (%zu threads)\n",
+                options.inputs.size() - num_failed.load(), options.inputs.size(), total, seconds,
+                total / std::max(seconds, 1e-9), num_threads);
+    return num_failed.load() == 0 ? 0 : 1;
+}